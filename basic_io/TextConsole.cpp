@@ -2,7 +2,9 @@
 
 #include "screen/glyphs/letters.hpp"
 #include "screen/screen.hpp"
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 
 namespace {
@@ -15,7 +17,9 @@ constexpr bool check_if_printable(const char c) {
   // or, if c > 31 and c < 127
   return c > 31 && c < 127;
 }
-constexpr bool check_if_newline(const char c) { return c == '\n' || c == '\r'; }
+constexpr bool check_if_newline(const char c) { return c == '\n'; }
+constexpr bool check_if_carriage_return(const char c) { return c == '\r'; }
+constexpr bool check_if_escape(const char c) { return c == 0x1b; }
 constexpr bool check_if_tab(const char c) { return c == '\t'; }
 constexpr bool check_if_null(const char ch) { return ch == '\0'; }
 constexpr bool check_if_backspace(const char ch) { return ch == 0x08; }
@@ -26,12 +30,74 @@ namespace screen {
 
 int TextConsole::console_column_count() const noexcept {
   const auto dims{get_console_width_and_height()};
-  return dims.width;
+  return std::min(dims.width, MAX_COLUMNS);
 }
 int TextConsole::console_line_count() const noexcept {
   const auto dims{get_console_width_and_height()};
-  return dims.height;
+  return std::min(dims.height, MAX_LINES);
 }
+
+TextConsole::Line &TextConsole::live_line(uint32_t line) noexcept {
+  return m_ring[(m_top + line) % RING_LINES];
+}
+const TextConsole::Line &
+TextConsole::shown_line(uint32_t line) const noexcept {
+  return m_ring[(m_top + RING_LINES - m_view_off + line) % RING_LINES];
+}
+
+void TextConsole::mark_dirty(uint32_t line, uint32_t column,
+                             uint32_t count) noexcept {
+  m_dirty[line] |= ((DirtyMask{1} << count) - 1) << column;
+}
+void TextConsole::mark_all_dirty() noexcept {
+  for (int line = 0; line < console_line_count(); ++line) {
+    mark_dirty(line, 0, console_column_count());
+  }
+}
+
+void TextConsole::put_cell(char c) noexcept {
+  live_line(m_line)[m_column] = {.c = c, .attr = m_attr};
+  mark_dirty(m_line, m_column, 1);
+}
+
+void TextConsole::erase(uint32_t line, uint32_t first_column,
+                        uint32_t last_column) {
+  auto &cells{live_line(line)};
+  for (uint32_t column = first_column; column <= last_column; ++column) {
+    cells[column] = {.c = ' ', .attr = DEFAULT_ATTR};
+  }
+  mark_dirty(line, first_column, last_column - first_column + 1);
+}
+
+void TextConsole::render() {
+  std::array<char, MAX_COLUMNS> run;
+  for (int line = 0; line < console_line_count(); ++line) {
+    auto mask{m_dirty[line]};
+    m_dirty[line] = 0;
+    const auto &cells{shown_line(line)};
+    while (mask != 0) {
+      /* a run is dirty cells in a row that share their attributes */
+      const auto column{static_cast<uint32_t>(std::countr_zero(mask))};
+      const auto dirty{static_cast<uint32_t>(std::countr_one(mask >> column))};
+      const auto attr{cells[column].attr};
+      uint32_t count{0};
+      while (count < dirty && cells[column + count].attr == attr) {
+        run[count] = cells[column + count].c;
+        ++count;
+      }
+      draw_letters(column, line, std::data(run), count,
+                   (attr & ATTR_REVERSE) != 0);
+      mask &= ~(((DirtyMask{1} << count) - 1) << column);
+    }
+  }
+}
+
+void TextConsole::draw_cursor(char c) {
+  if (m_view_off == 0 && m_cursor_visible) {
+    draw_letter(m_column, m_line, c);
+  }
+}
+
 void TextConsole::decrement_column() {
   if (m_column == 1) {
     jump_to_previous_row();
@@ -52,11 +118,24 @@ void TextConsole::decrement_row() {
   }
 }
 void TextConsole::increment_row() {
-  if (m_line == console_line_count() - 1) {
-    scroll_up(1);
-  } else {
+  if (m_line != console_line_count() - 1) {
     ++m_line;
+    return;
   }
+
+  /* the top line joins the scrollback, a blank one comes in at the bottom */
+  const auto lines{console_line_count()};
+  m_top = (m_top + 1) % RING_LINES;
+  m_history = std::min(m_history + 1, RING_LINES - lines);
+  live_line(lines - 1).fill({.c = ' ', .attr = DEFAULT_ATTR});
+
+  /* the pixels move the same way (blank bottom line and all), so pending
+   * redraws move with them */
+  scroll_up(1);
+  for (int line = 0; line < lines - 1; ++line) {
+    m_dirty[line] = m_dirty[line + 1];
+  }
+  m_dirty[lines - 1] = 0;
 }
 void TextConsole::jump_to_previous_row() {
   decrement_row();
@@ -67,40 +146,270 @@ void TextConsole::jump_to_new_row() {
   m_column = 0;
 }
 
-TextConsole::TextConsole() : m_column{START_COLUMN}, m_line{START_LINE} {}
+TextConsole::TextConsole()
+    : m_dirty{}, m_top{0}, m_history{0}, m_view_off{0}, m_column{START_COLUMN},
+      m_line{START_LINE}, m_attr{DEFAULT_ATTR}, m_cursor_visible{true},
+      m_state{ParseState::GROUND}, m_csi_private{false}, m_param_count{0},
+      m_params{}, m_saved{.column = START_COLUMN,
+                          .line = START_LINE,
+                          .attr = DEFAULT_ATTR} {
+  for (auto &line : m_ring) {
+    line.fill({.c = ' ', .attr = DEFAULT_ATTR});
+  }
+}
 
 void TextConsole::clear() {
+  for (int line = 0; line < console_line_count(); ++line) {
+    live_line(line).fill({.c = ' ', .attr = DEFAULT_ATTR});
+  }
+  m_dirty.fill(0);
+  m_view_off = 0;
   clear_console();
   m_column = START_COLUMN;
   m_line = START_LINE;
 }
 
-void TextConsole::putc(char c) {
-  if (check_if_printable(c)) {
-    draw_letter(m_column, m_line, c);
-    increment_column();
-    draw_letter(m_column, m_line, '_');
+void TextConsole::putc(char c) { write(&c, 1); }
+
+void TextConsole::write(const char *str, size_t len) {
+  if (len == 0) {
     return;
   }
-  if (check_if_newline(c)) {
-    draw_letter(m_column, m_line, ' ');
-    jump_to_new_row();
-    draw_letter(m_column, m_line, '_');
+  if (m_view_off != 0) {
+    /* snap back to the live screen */
+    m_view_off = 0;
+    mark_all_dirty();
+  }
+  /* lift the cursor by redrawing whatever is under it */
+  mark_dirty(m_line, m_column, 1);
+
+  size_t idx{0};
+  while (idx < len) {
+    const char c{str[idx]};
+    if (m_state == ParseState::ESCAPE) {
+      parse_escape(c);
+      ++idx;
+      continue;
+    }
+    if (m_state == ParseState::CSI) {
+      parse_csi(c);
+      ++idx;
+      continue;
+    }
+    if (check_if_printable(c)) {
+      /* gather up everything printable that fits on this line */
+      const size_t room{console_column_count() - m_column};
+      size_t count{1};
+      while (count < room && idx + count < len &&
+             check_if_printable(str[idx + count])) {
+        ++count;
+      }
+      auto &cells{live_line(m_line)};
+      for (size_t off = 0; off < count; ++off) {
+        cells[m_column + off] = {.c = str[idx + off], .attr = m_attr};
+      }
+      mark_dirty(m_line, m_column, count);
+      idx += count;
+      m_column += count - 1;
+      increment_column();
+      continue;
+    }
+    if (check_if_escape(c)) {
+      m_state = ParseState::ESCAPE;
+    } else if (check_if_newline(c)) {
+      jump_to_new_row();
+    } else if (check_if_carriage_return(c)) {
+      m_column = 0;
+    } else if (check_if_tab(c)) {
+      put_cell(' ');
+      increment_column();
+      put_cell(' ');
+      increment_column();
+    } else if (check_if_backspace(c)) {
+      put_cell(' ');
+      decrement_column();
+    }
+    ++idx;
+  }
+
+  render();
+  draw_cursor('_');
+}
+
+void TextConsole::view_scrollback(uint32_t lines_back) {
+  lines_back = std::min(lines_back, m_history);
+  if (lines_back == m_view_off) {
+    return;
+  }
+  /* the cursor cell gets redrawn along with everything else */
+  m_view_off = lines_back;
+  mark_all_dirty();
+  render();
+  draw_cursor('_');
+}
+
+uint32_t TextConsole::scrollback_depth() const noexcept { return m_history; }
+
+/* =========================================================== */
+/*                  Escape Sequences                           */
+/* =========================================================== */
+void TextConsole::parse_escape(char c) {
+  m_state = ParseState::GROUND;
+  switch (c) {
+  case '[':
+    m_state = ParseState::CSI;
+    m_csi_private = false;
+    m_param_count = 0;
+    m_params.fill(0);
+    break;
+  case '7':
+    m_saved = {.column = m_column, .line = m_line, .attr = m_attr};
+    break;
+  case '8':
+    m_column = m_saved.column;
+    m_line = m_saved.line;
+    m_attr = m_saved.attr;
+    break;
+  default:
+    /* unsupported, drop it */
+    break;
+  }
+}
+
+void TextConsole::parse_csi(char c) {
+  if (c >= '0' && c <= '9') {
+    if (m_param_count == 0) {
+      m_param_count = 1;
+    }
+    if (m_param_count <= MAX_CSI_PARAMS) {
+      auto &param{m_params[m_param_count - 1]};
+      param = std::min<uint32_t>(param * 10 + (c - '0'), UINT16_MAX);
+    }
+    return;
+  }
+  if (c == ';') {
+    /* an empty first parameter still counts */
+    m_param_count = std::max<uint8_t>(m_param_count, 1) + 1;
     return;
   }
-  if (check_if_tab(c)) {
-    draw_letter(m_column, m_line, ' ');
-    increment_column();
-    draw_letter(m_column, m_line, ' ');
-    increment_column();
-    draw_letter(m_column, m_line, '_');
+  if (c == '?') {
+    m_csi_private = true;
     return;
   }
-  if (check_if_backspace(c)) {
-    draw_letter(m_column, m_line, ' ');
-    decrement_column();
-    draw_letter(m_column, m_line, '_');
+  if (c >= 0x40 && c <= 0x7e) {
+    m_state = ParseState::GROUND;
+    dispatch_csi(c);
+  }
+  /* anything else (intermediates, stray controls) is ignored */
+}
+
+uint32_t TextConsole::csi_param(uint32_t idx,
+                                uint32_t default_value) const noexcept {
+  if (idx >= m_param_count || idx >= MAX_CSI_PARAMS || m_params[idx] == 0) {
+    return default_value;
+  }
+  return m_params[idx];
+}
+
+void TextConsole::dispatch_csi(char command) {
+  const uint32_t last_column{static_cast<uint32_t>(console_column_count() - 1)};
+  const uint32_t last_line{static_cast<uint32_t>(console_line_count() - 1)};
+
+  if (m_csi_private) {
+    /* only cursor visibility, DECTCEM */
+    if (csi_param(0, 0) == 25 && (command == 'h' || command == 'l')) {
+      m_cursor_visible = command == 'h';
+    }
+    return;
+  }
+
+  switch (command) {
+  case 'A':
+    m_line -= std::min(csi_param(0, 1), m_line);
+    break;
+  case 'B':
+    m_line = std::min(m_line + csi_param(0, 1), last_line);
+    break;
+  case 'C':
+    m_column = std::min(m_column + csi_param(0, 1), last_column);
+    break;
+  case 'D':
+    m_column -= std::min(csi_param(0, 1), m_column);
+    break;
+  case 'H':
+  case 'f':
+    m_line = std::min(csi_param(0, 1), last_line + 1) - 1;
+    m_column = std::min(csi_param(1, 1), last_column + 1) - 1;
+    break;
+  case 'J': {
+    const auto mode{m_param_count > 0 ? m_params[0] : 0U};
+    if (mode == 0) {
+      erase(m_line, m_column, last_column);
+      for (uint32_t line = m_line + 1; line <= last_line; ++line) {
+        erase(line, 0, last_column);
+      }
+    } else if (mode == 1) {
+      for (uint32_t line = 0; line < m_line; ++line) {
+        erase(line, 0, last_column);
+      }
+      erase(m_line, 0, m_column);
+    } else if (mode == 2) {
+      for (uint32_t line = 0; line <= last_line; ++line) {
+        erase(line, 0, last_column);
+      }
+    }
+    break;
+  }
+  case 'K': {
+    const auto mode{m_param_count > 0 ? m_params[0] : 0U};
+    if (mode == 0) {
+      erase(m_line, m_column, last_column);
+    } else if (mode == 1) {
+      erase(m_line, 0, m_column);
+    } else if (mode == 2) {
+      erase(m_line, 0, last_column);
+    }
+    break;
+  }
+  case 's':
+    m_saved = {.column = m_column, .line = m_line, .attr = m_attr};
+    break;
+  case 'u':
+    m_column = m_saved.column;
+    m_line = m_saved.line;
+    m_attr = m_saved.attr;
+    break;
+  case 'm':
+    select_graphic_rendition();
+    break;
+  default:
+    /* unsupported, drop it */
+    break;
+  }
+}
+
+void TextConsole::select_graphic_rendition() {
+  /* no parameters at all means reset */
+  const uint32_t count{std::max<uint32_t>(
+      std::min<uint32_t>(m_param_count, MAX_CSI_PARAMS), 1)};
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    const uint32_t code{m_params[idx]};
+    if (code == 0) {
+      m_attr = DEFAULT_ATTR;
+    } else if (code == 7) {
+      m_attr |= ATTR_REVERSE;
+    } else if (code == 27) {
+      m_attr &= ~ATTR_REVERSE;
+    } else if (code >= 30 && code <= 37) {
+      m_attr = (m_attr & ~ATTR_FG_MASK) | (code - 30);
+    } else if (code == 39) {
+      m_attr = (m_attr & ~ATTR_FG_MASK) | (DEFAULT_ATTR & ATTR_FG_MASK);
+    } else if (code >= 40 && code <= 47) {
+      m_attr = (m_attr & ~ATTR_BG_MASK) | ((code - 40) << ATTR_BG_SHIFT);
+    } else if (code == 49) {
+      m_attr = (m_attr & ~ATTR_BG_MASK) | (DEFAULT_ATTR & ATTR_BG_MASK);
+    }
   }
 }
 
-} // namespace screen
\ No newline at end of file
+} // namespace screen
@@ -1,10 +1,30 @@
 #if !defined(TEXTCONSOLE_HPP)
 #define TEXTCONSOLE_HPP
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace screen {
 
+/** @brief Character-cell terminal on top of the console screen mode.
+ *
+ * Text lives in a ring of lines (the visible screen plus some scrollback).
+ * Writing only touches cells and marks them dirty; the framebuffer is brought
+ * up to date once per write, redrawing just the dirty cells.
+ *
+ * Understands a small VT100 subset, so callers can update text in place:
+ *   ESC 7, ESC 8        save / restore cursor and attributes
+ *   CSI r;c H, CSI r;c f  move cursor (1-based)
+ *   CSI n A/B/C/D       cursor up/down/right/left
+ *   CSI n J             erase in screen (0: to end, 1: to cursor, 2: all)
+ *   CSI n K             erase in line (0: to end, 1: to cursor, 2: all)
+ *   CSI s, CSI u        save / restore cursor and attributes
+ *   CSI ?25 h/l         show / hide the cursor
+ *   CSI ... m           SGR: 0, 7, 27, 30-37, 39, 40-47, 49
+ * Colors are remembered per cell, but the 1bpp console can only show reverse
+ * video.
+ */
 class TextConsole {
 public:
   TextConsole();
@@ -12,16 +32,92 @@ public:
   void clear();
   void putc(char c);
 
+  /** @brief Print a run of characters.
+   *
+   * Consecutive printable characters on one line are drawn together, and the
+   * cursor is only redrawn once, at the end.
+   */
+  void write(const char *str, size_t len);
+
+  /** @brief Show older output.
+   *
+   * @param lines_back How far above the live screen to look.  Clamped to
+   * scrollback_depth().  0 returns to the live screen, as does any write.
+   */
+  void view_scrollback(uint32_t lines_back);
+
+  /** @return Number of lines of history above the live screen. */
+  [[nodiscard]] uint32_t scrollback_depth() const noexcept;
+
 private:
   static constexpr uint32_t START_COLUMN{0};
   static constexpr uint32_t START_LINE{0};
 
+  static constexpr uint8_t ATTR_FG_MASK{0b0000'0111};
+  static constexpr uint8_t ATTR_BG_SHIFT{3};
+  static constexpr uint8_t ATTR_BG_MASK{0b0011'1000};
+  static constexpr uint8_t ATTR_REVERSE{0b0100'0000};
+  static constexpr uint8_t DEFAULT_ATTR{7}; /* white on black */
+
+  static constexpr uint32_t MAX_CSI_PARAMS{4};
+
+  static constexpr uint32_t MAX_COLUMNS{40};
+  static constexpr uint32_t MAX_LINES{40};
+  static constexpr uint32_t RING_LINES{96};
+  static_assert(RING_LINES > MAX_LINES);
+
+  struct Cell {
+    char c;
+    uint8_t attr;
+  };
+  using Line = std::array<Cell, MAX_COLUMNS>;
+  using DirtyMask = uint64_t;
+  static_assert(sizeof(DirtyMask) * 8 >= MAX_COLUMNS);
+
+  std::array<Line, RING_LINES> m_ring;
+  std::array<DirtyMask, MAX_LINES> m_dirty;
+  uint32_t m_top;      /* ring index of the live screen's first line */
+  uint32_t m_history;  /* valid lines in the ring above m_top */
+  uint32_t m_view_off; /* lines above the live screen being shown */
+
   uint32_t m_column;
   uint32_t m_line;
+  uint8_t m_attr;
+  bool m_cursor_visible;
+
+  /* escape sequence parsing */
+  enum struct ParseState : uint8_t { GROUND, ESCAPE, CSI };
+  ParseState m_state;
+  bool m_csi_private;
+  uint8_t m_param_count;
+  std::array<uint16_t, MAX_CSI_PARAMS> m_params;
+
+  struct SavedCursor {
+    uint32_t column;
+    uint32_t line;
+    uint8_t attr;
+  };
+  SavedCursor m_saved;
 
   [[nodiscard]] int console_column_count() const noexcept;
   [[nodiscard]] int console_line_count() const noexcept;
 
+  [[nodiscard]] Line &live_line(uint32_t line) noexcept;
+  [[nodiscard]] const Line &shown_line(uint32_t line) const noexcept;
+  void mark_dirty(uint32_t line, uint32_t column, uint32_t count) noexcept;
+  void mark_all_dirty() noexcept;
+  void put_cell(char c) noexcept;
+  void erase(uint32_t line, uint32_t first_column, uint32_t last_column);
+  void render();
+  void draw_cursor(char c);
+
+  void parse_escape(char c);
+  void parse_csi(char c);
+  void dispatch_csi(char command);
+  void select_graphic_rendition();
+  [[nodiscard]] uint32_t csi_param(uint32_t idx,
+                                   uint32_t default_value) const noexcept;
+
   void decrement_column();
   void increment_column();
   void decrement_row();
@@ -11,26 +11,50 @@
 
 #include "pico/stdio.h"
 #include "pico/stdio/driver.h"
+#include "pico/time.h"
 #if defined(BUILD_WITH_STDIO_USB)
 #include "pico/stdio_usb.h"
 #endif
 
 namespace {
 
+/* the timer starts from 0 at reset, so these are time since reset */
+std::array<uint64_t, static_cast<size_t>(bsio::BootPhase::COUNT)>
+    g_boot_phase_us{};
+
 #if !defined(BUILD_WITH_STDIO_USB)
 screen::TextConsole wrt;
 
-/* callbacks for stdio_driver_t */
-void my_out_chars(const char *buf, int len) {
-  if (screen::get_format() != screen::Format::GREY1) {
+/* Output is held here until a newline, a flush, a full buffer, or someone
+ * wants input, then handed to the console in one go.  Drawing a whole line at
+ * once is a lot cheaper than a glyph (and a cursor) per character. */
+std::array<char, 128> g_line_buffer;
+size_t g_line_length{0};
+
+void flush_line_buffer() {
+  if (g_line_length == 0) {
     return;
   }
+  if (screen::get_format() == screen::Format::GREY1) {
+    wrt.write(std::data(g_line_buffer), g_line_length);
+  }
+  g_line_length = 0;
+}
+
+/* callbacks for stdio_driver_t */
+void my_out_chars(const char *buf, int len) {
   for (int ii = 0; ii < len; ++ii) {
-    wrt.putc(buf[ii]);
+    g_line_buffer[g_line_length++] = buf[ii];
+    if (buf[ii] == '\n' || g_line_length == std::size(g_line_buffer)) {
+      flush_line_buffer();
+    }
   }
 }
-void my_out_flush() { /* do nothing, we don't buffer... right meow */ }
+void my_out_flush() { flush_line_buffer(); }
 int my_in_chars(char *buf, int len) {
+  /* whatever prompted for this input should be on screen first */
+  flush_line_buffer();
+
   /* we block until we get all the keys! */
   keyboard::result_t err;
   for (int ii = 0; ii < len; ++ii) {
@@ -56,15 +80,53 @@ void stdio_init_mine() {
 namespace bsio {
 
 bool init() {
+  mark_boot_phase(BootPhase::SCREEN_INIT);
   if (!screen::set_console_mode()) {
     return false;
   }
+  mark_boot_phase(BootPhase::SCREEN_READY);
 #if defined(BUILD_WITH_STDIO_USB)
   stdio_usb_init();
 #else
   stdio_init_mine();
 #endif
+  mark_boot_phase(BootPhase::CONSOLE_READY);
   return true;
 }
 
+void mark_boot_phase(BootPhase phase) {
+  auto &when{g_boot_phase_us[static_cast<size_t>(phase)]};
+  if (when == 0) {
+    when = time_us_64();
+  }
+}
+
+uint64_t boot_phase_us(BootPhase phase) {
+  return g_boot_phase_us[static_cast<size_t>(phase)];
+}
+
+void clear() {
+#if !defined(BUILD_WITH_STDIO_USB)
+  flush_line_buffer();
+  wrt.clear();
+#else
+  screen::clear_console();
+#endif
+}
+
+void view_scrollback([[maybe_unused]] uint32_t lines_back) {
+#if !defined(BUILD_WITH_STDIO_USB)
+  flush_line_buffer();
+  wrt.view_scrollback(lines_back);
+#endif
+}
+
+uint32_t scrollback_depth() {
+#if !defined(BUILD_WITH_STDIO_USB)
+  return wrt.scrollback_depth();
+#else
+  return 0;
+#endif
+}
+
 } // namespace bsio
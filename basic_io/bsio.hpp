@@ -1,10 +1,41 @@
 #if !defined(BSIO_HPP)
 #define BSIO_HPP
 
+#include <cstdint>
+
 namespace bsio {
 
 bool init();
 
+/** @brief Milestones between reset and a usable screen, in the order they
+ * are reached. */
+enum struct BootPhase : uint8_t {
+  SCREEN_INIT,   /* init() starts bringing the panel up */
+  SCREEN_READY,  /* panel on, cleared and showing the framebuffer */
+  CONSOLE_READY, /* stdio goes to the screen */
+  MENU,          /* the menu is drawn */
+  COUNT
+};
+
+/** @brief Note that phase has been reached.  Only the first time counts. */
+void mark_boot_phase(BootPhase phase);
+
+/** @return Microseconds from reset to phase, or 0 if it was never reached. */
+[[nodiscard]] uint64_t boot_phase_us(BootPhase phase);
+
+/** @brief Blank the console and home the cursor.  Scrollback is kept. */
+void clear();
+
+/** @brief Show console output from before what's on screen now.
+ *
+ * @param lines_back How many lines to look back.  0 returns to the live
+ * screen; so does printing anything.
+ */
+void view_scrollback(uint32_t lines_back);
+
+/** @return How many lines view_scrollback can go back. */
+[[nodiscard]] uint32_t scrollback_depth();
+
 } // namespace bsio
 
 #endif
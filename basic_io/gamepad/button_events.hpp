@@ -0,0 +1,127 @@
+#if !defined(GAMEPAD_BUTTON_EVENTS_HPP)
+#define GAMEPAD_BUTTON_EVENTS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gamepad.hpp"
+
+namespace gamepad::five {
+
+enum struct EventKind : uint8_t {
+  PRESS,
+  RELEASE,
+  REPEAT, /* still held, auto-repeat came round again */
+};
+
+struct Event {
+  Button button;
+  EventKind kind;
+  uint32_t timestamp_us; /* time_us_32() of the poll that saw it */
+};
+
+struct RepeatConfig {
+  uint32_t delay_us{400 * 1000};    /* press to first repeat, 0 for none */
+  uint32_t interval_us{100 * 1000}; /* between repeats after that */
+};
+
+/** @brief Held mask, a bit per Button, as a State */
+[[nodiscard]] constexpr State to_state(uint32_t held) noexcept {
+  auto &&bit{[held](Button button) -> uint8_t {
+    return (held >> static_cast<uint32_t>(button)) & 1;
+  }};
+  return {.up = bit(Button::UP),
+          .down = bit(Button::DOWN),
+          .right = bit(Button::RIGHT),
+          .left = bit(Button::LEFT),
+          .etc = bit(Button::ETC),
+          .reserved = 0};
+}
+
+/** @brief Turns successive polls of which buttons are held into press,
+ * release and repeat events.
+ *
+ *  Cheap enough for the polling alarm: a pass over the five buttons.  Each
+ * repeat is timed from the one before, so a late poll doesn't shift the ones
+ * after it, but one that's very late gives a single repeat, not a burst.
+ */
+class EdgeDetector final {
+public:
+  constexpr EdgeDetector() noexcept = default;
+  explicit constexpr EdgeDetector(RepeatConfig cfg) noexcept : m_cfg{cfg} {}
+
+  [[nodiscard]] constexpr RepeatConfig config() const noexcept {
+    return m_cfg;
+  }
+  constexpr void config(RepeatConfig cfg) noexcept { m_cfg = cfg; }
+
+  [[nodiscard]] constexpr uint32_t held() const noexcept { return m_held; }
+
+  /** @brief Start over from held, without events for what is down already. */
+  constexpr void reset(uint32_t held, uint32_t now_us) noexcept {
+    m_held = held;
+    m_next_repeat_us.fill(now_us + m_cfg.delay_us);
+  }
+
+  /** @brief Hands emit(Event) whatever changed since the last call. */
+  template <class Emit>
+  constexpr void update(uint32_t held, uint32_t now_us, Emit &&emit) {
+    const uint32_t changed{held ^ m_held};
+    for (uint32_t idx = 0; idx < BUTTON_COUNT; ++idx) {
+      const uint32_t mask{1U << idx};
+      const auto button{static_cast<Button>(idx)};
+      if (changed & mask) {
+        const bool down{(held & mask) != 0};
+        emit(Event{.button = button,
+                   .kind = down ? EventKind::PRESS : EventKind::RELEASE,
+                   .timestamp_us = now_us});
+        m_next_repeat_us[idx] = now_us + m_cfg.delay_us;
+      } else if ((held & mask) && m_cfg.delay_us != 0 &&
+                 static_cast<int32_t>(now_us - m_next_repeat_us[idx]) >= 0) {
+        emit(Event{.button = button,
+                   .kind = EventKind::REPEAT,
+                   .timestamp_us = now_us});
+        m_next_repeat_us[idx] += m_cfg.interval_us;
+        if (static_cast<int32_t>(now_us - m_next_repeat_us[idx]) >= 0) {
+          m_next_repeat_us[idx] = now_us + m_cfg.interval_us;
+        }
+      }
+    }
+    m_held = held;
+  }
+
+private:
+  static constexpr uint32_t BUTTON_COUNT{
+      static_cast<uint32_t>(Button::ETC) + 1};
+
+  RepeatConfig m_cfg{};
+  uint32_t m_held{0};
+  std::array<uint32_t, BUTTON_COUNT> m_next_repeat_us{};
+};
+
+/** @brief The oldest button event not yet read.
+ *
+ *  Events are queued by the polling alarm, so latency is at most one poll
+ * interval, and nothing has to wait for a button to be let go.  Buttons
+ * already down when init() is called give no press.
+ *
+ * @return False if there are none.
+ */
+[[nodiscard]] bool get_event(Event &out) noexcept;
+
+/** @brief Throw away every queued event, e.g. ones meant for whatever ran
+ * before. */
+void flush_events() noexcept;
+
+/** @brief Events lost because nobody was reading, since power up.  Wraps. */
+[[nodiscard]] uint32_t get_events_dropped() noexcept;
+
+/** @brief Takes effect from the next poll.  Call it from the core that
+ * called init(), which is the one the alarm runs on. */
+void set_repeat(RepeatConfig cfg) noexcept;
+[[nodiscard]] RepeatConfig get_repeat() noexcept;
+
+} // namespace gamepad::five
+
+#endif
@@ -0,0 +1,87 @@
+#if !defined(GAMEPAD_DEBOUNCE_HPP)
+#define GAMEPAD_DEBOUNCE_HPP
+
+#include <bit>
+#include <cstdint>
+
+namespace gamepad {
+
+struct DebounceStats {
+  uint32_t polls;
+  uint32_t accepted; /* transitions that held for long enough */
+  uint32_t rejected; /* ones that bounced back before then */
+};
+
+/** @brief Debounces up to 32 inputs at once, with a two bit vertical counter
+ * per input.
+ *
+ *  Bit n of the two counter words together count how many polls in a row
+ * input n has disagreed with its debounced state.  Agreeing resets the count,
+ * and the fourth disagreement in a row flips the state.  All inputs step
+ * together in a handful of word-wide logic operations, however many there
+ * are, so it costs the same for the five pad or an eight pad.
+ *
+ *  So a change shows up three polls after it is first seen, and any blip
+ * shorter than four polls never shows up at all; size the poll interval to
+ * suit the switches' bounce.
+ */
+class Debouncer final {
+public:
+  constexpr Debouncer() noexcept = default;
+
+  /** @brief Take state as settled, e.g. at power up. */
+  constexpr void reset(uint32_t state) noexcept {
+    m_state = state;
+    m_count0 = 0;
+    m_count1 = 0;
+  }
+
+  /** @return The debounced state, after this sample. */
+  constexpr uint32_t update(uint32_t sample) noexcept {
+    const uint32_t delta{sample ^ m_state};
+    const uint32_t pending{m_count0 | m_count1};
+
+    m_count1 = (m_count1 ^ m_count0) & delta;
+    m_count0 = ~m_count0 & delta;
+    const uint32_t toggle{delta & ~(m_count0 | m_count1)};
+    m_state ^= toggle;
+
+    ++m_stats.polls;
+    m_stats.accepted += std::popcount(toggle);
+    /* counting, but this sample agrees again */
+    m_stats.rejected += std::popcount(pending & ~delta);
+    return m_state;
+  }
+
+  [[nodiscard]] constexpr uint32_t state() const noexcept { return m_state; }
+  [[nodiscard]] constexpr DebounceStats stats() const noexcept {
+    return m_stats;
+  }
+
+private:
+  uint32_t m_state{0};
+  uint32_t m_count0{0};
+  uint32_t m_count1{0};
+  DebounceStats m_stats{};
+};
+
+} // namespace gamepad
+
+namespace gamepad::five {
+
+/** @brief How often the buttons are sampled, and so debounced over four of.
+ *
+ *  Takes effect from the next poll.
+ *
+ * @return What was set, after clamping to what the alarm can manage.
+ */
+uint32_t set_poll_interval_us(uint32_t interval_us) noexcept;
+[[nodiscard]] uint32_t get_poll_interval_us() noexcept;
+
+/** @brief Since power up.  Wraps; read while the alarm runs, so the fields
+ * may be a poll apart. */
+[[nodiscard]] DebounceStats get_debounce_stats() noexcept;
+
+} // namespace gamepad::five
+
+#endif
@@ -1,10 +1,22 @@
 #include "gamepad.hpp"
 
+#include <algorithm>
 #include <array>
 
 #include "hardware/gpio.h"
 #include "pico/time.h"
 
+#include "../screen/screen.hpp"
+#include "button_events.hpp"
+#include "debounce.hpp"
+#include "embp/spsc_ring.hpp"
+#include "touch_pad.hpp"
+
+/* button events that can wait to be read, a power of two */
+#if !defined(GAMEPAD_EVENT_QUEUE_DEPTH)
+#define GAMEPAD_EVENT_QUEUE_DEPTH (16)
+#endif
+
 /* ======================================================================= *
                      ____        ____   _    ____
                     | ___|      |  _ \ / \  |  _ \
@@ -16,7 +28,10 @@
 namespace gamepad::five {
 
 /* some defaults */
-static constexpr int64_t DEFAULT_POLL_INTERVAL_US{10000}; /* ever 10 ms */
+static constexpr uint32_t DEFAULT_POLL_INTERVAL_US{2000}; /* every 2 ms */
+/* the alarm pool can't keep up with much less, and much more is sluggish */
+static constexpr uint32_t MIN_POLL_INTERVAL_US{250};
+static constexpr uint32_t MAX_POLL_INTERVAL_US{50000};
 
 /* some bsp level stuff, to be abstracted away? This is for the breadboard
  * setup. */
@@ -31,9 +46,9 @@ static constexpr uint32_t GPIOS_USED{
     (1 << BREADBOARD_PAD_ETC)};
 
 struct PadControl {
-  int64_t poll_interval;
+  uint32_t poll_interval;
   alarm_id_t id;
-  uint32_t gpio_pins_state;
+  uint32_t held; /* debounced, a bit per Button */
 };
 
 /* our static state for the module*/
@@ -41,6 +56,31 @@ bool g_initialized{false};
 static PadControl g_control{
     .poll_interval = DEFAULT_POLL_INTERVAL_US,
 };
+static TouchPad *g_touch_pad{nullptr};
+static uint32_t g_touch_held{0}; /* the pad's buttons, for the alarm */
+
+/* the alarm makes events, whoever reads the pad takes them */
+static Debouncer g_debouncer;
+static EdgeDetector g_detector;
+static embp::spsc_ring<Event, GAMEPAD_EVENT_QUEUE_DEPTH> g_events;
+
+/* set_repeat() leaves a new config here and the alarm takes it from there,
+ * so the detector never sees half of one */
+static RepeatConfig g_repeat{};
+static bool g_repeat_changed{false};
+
+/* buttons are pulled up, so held is low; a bit per Button */
+[[nodiscard]] static uint32_t held_buttons(uint32_t pins) noexcept {
+  auto &&is_clear{[pins](uint32_t gpio_num, Button button) -> uint32_t {
+    return ((pins >> gpio_num) & 0b1) == 0 ? 1U << static_cast<uint32_t>(button)
+                                           : 0;
+  }};
+  return is_clear(BREADBOARD_PAD_UP, Button::UP) |
+         is_clear(BREADBOARD_PAD_DOWN, Button::DOWN) |
+         is_clear(BREADBOARD_PAD_RIGHT, Button::RIGHT) |
+         is_clear(BREADBOARD_PAD_LEFT, Button::LEFT) |
+         is_clear(BREADBOARD_PAD_ETC, Button::ETC);
+}
 
 static int64_t polling_callback(alarm_id_t id, void *user_data) {
   PadControl *p_state = reinterpret_cast<PadControl *>(user_data);
@@ -48,10 +88,23 @@ static int64_t polling_callback(alarm_id_t id, void *user_data) {
     return 0;
   }
 
+  if (__atomic_load_n(&g_repeat_changed, __ATOMIC_ACQUIRE)) {
+    __atomic_store_n(&g_repeat_changed, false, __ATOMIC_RELAXED);
+    g_detector.config(g_repeat);
+  }
+
   /* read our pins */
-  p_state->gpio_pins_state = gpio_get_all();
+  const uint32_t buttons{g_debouncer.update(held_buttons(gpio_get_all()))};
+  __atomic_store_n(&p_state->held, buttons, __ATOMIC_RELAXED);
 
-  return -(p_state->poll_interval); /* resets the alarm */
+  const uint32_t held{buttons |
+                      __atomic_load_n(&g_touch_held, __ATOMIC_RELAXED)};
+  g_detector.update(held, time_us_32(),
+                    [](const Event &event) { g_events.push(event); });
+
+  /* resets the alarm, picking up any new interval */
+  return -static_cast<int64_t>(
+      __atomic_load_n(&p_state->poll_interval, __ATOMIC_RELAXED));
 }
 
 static void configure_timer() noexcept {
@@ -79,6 +132,11 @@ static void configure_gpios() noexcept {
 void init() noexcept {
   if (!g_initialized) {
     configure_gpios();
+    /* what is down already was pressed for somebody else */
+    g_control.held = held_buttons(gpio_get_all());
+    g_debouncer.reset(g_control.held);
+    g_detector.reset(g_control.held | g_touch_held, time_us_32());
+    flush_events();
     configure_timer();
     g_initialized = true;
   }
@@ -92,21 +150,67 @@ void deinit() noexcept {
   }
 }
 
+void set_touch_pad(TouchPad *pad) noexcept {
+  g_touch_pad = pad;
+  __atomic_store_n(&g_touch_held, 0, __ATOMIC_RELAXED);
+}
+TouchPad *get_touch_pad() noexcept { return g_touch_pad; }
+
+/* Catch the touch pad up with whatever was touched since the last call.  The
+ * alarm picks the result up on its next poll, for the events. */
+static uint32_t get_touch() noexcept {
+  if (g_touch_pad == nullptr) {
+    return 0;
+  }
+  std::array<screen::TouchReport, TOUCH_PAD_REPORTS_PER_GET> reports;
+  const uint32_t count{
+      screen::get_touch_reports(std::data(reports), std::size(reports))};
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    g_touch_pad->feed(reports[idx]);
+  }
+  const uint32_t held{g_touch_pad->held()};
+  __atomic_store_n(&g_touch_held, held, __ATOMIC_RELAXED);
+  return held;
+}
+
 [[nodiscard]] State get() noexcept {
+  return to_state(__atomic_load_n(&g_control.held, __ATOMIC_RELAXED) |
+                  get_touch());
+}
 
-  const uint32_t current_pins{g_control.gpio_pins_state};
+[[nodiscard]] bool get_event(Event &out) noexcept {
+  (void)get_touch();
+  return g_events.pop(out);
+}
+void flush_events() noexcept {
+  Event dropped;
+  while (g_events.pop(dropped)) {
+    /* nobody wants them */
+  }
+}
+[[nodiscard]] uint32_t get_events_dropped() noexcept {
+  return g_events.dropped();
+}
 
-  auto &&is_clear{
-      [](const uint32_t pins_state, const uint32_t gpio_num) -> uint8_t {
-        return static_cast<uint8_t>((pins_state >> gpio_num) & 0b1) == 0;
-      }};
+void set_repeat(RepeatConfig cfg) noexcept {
+  /* the alarm leaves g_repeat be while we write it */
+  __atomic_store_n(&g_repeat_changed, false, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  g_repeat = cfg;
+  __atomic_store_n(&g_repeat_changed, true, __ATOMIC_RELEASE);
+}
+RepeatConfig get_repeat() noexcept { return g_repeat; }
 
-  return {.up = is_clear(current_pins, BREADBOARD_PAD_UP),
-          .down = is_clear(current_pins, BREADBOARD_PAD_DOWN),
-          .right = is_clear(current_pins, BREADBOARD_PAD_RIGHT),
-          .left = is_clear(current_pins, BREADBOARD_PAD_LEFT),
-          .etc = is_clear(current_pins, BREADBOARD_PAD_ETC)};
+uint32_t set_poll_interval_us(uint32_t interval_us) noexcept {
+  interval_us = std::clamp(interval_us, MIN_POLL_INTERVAL_US,
+                           MAX_POLL_INTERVAL_US);
+  __atomic_store_n(&g_control.poll_interval, interval_us, __ATOMIC_RELAXED);
+  return interval_us;
+}
+uint32_t get_poll_interval_us() noexcept {
+  return __atomic_load_n(&g_control.poll_interval, __ATOMIC_RELAXED);
 }
+DebounceStats get_debounce_stats() noexcept { return g_debouncer.stats(); }
 
 } // namespace gamepad::five
 
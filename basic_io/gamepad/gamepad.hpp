@@ -14,6 +14,8 @@ struct State {
   uint8_t reserved : 3;
 };
 
+enum struct Button : uint8_t { UP, DOWN, RIGHT, LEFT, ETC };
+
 /* we are initialized by bsio::init() */
 /* just 5 buttons, all direct GPIOs */
 void init() noexcept;
@@ -0,0 +1,117 @@
+#if !defined(GAMEPAD_TOUCH_PAD_HPP)
+#define GAMEPAD_TOUCH_PAD_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../screen/screen_def.h"
+#include "button_events.hpp"
+#include "gamepad.hpp"
+
+/* Touch reports get() takes off the queue per call, when a pad is set. */
+#if !defined(TOUCH_PAD_REPORTS_PER_GET)
+#define TOUCH_PAD_REPORTS_PER_GET 16
+#endif
+
+namespace gamepad::five {
+
+/** @brief Pressing anywhere inside area holds button down. */
+struct TouchZone {
+  screen::Region area; /* in touch report pixels */
+  Button button;
+};
+
+/** @brief On-screen buttons, fed from the touch report stream.
+ *
+ *  A button is held for as long as the pen is down inside one of its zones,
+ * and zones may overlap (e.g. a diagonal).  Each report costs one pass over
+ * at most MAX_ZONES rectangles.
+ */
+class TouchPad final {
+public:
+  static constexpr size_t MAX_ZONES{8};
+
+  /** @return False if there is no room left. */
+  constexpr bool add(TouchZone zone) noexcept {
+    if (m_count == MAX_ZONES) {
+      return false;
+    }
+    m_zones[m_count++] = zone;
+    return true;
+  }
+  constexpr void clear() noexcept {
+    m_count = 0;
+    m_held = 0;
+  }
+  [[nodiscard]] constexpr size_t size() const noexcept { return m_count; }
+
+  constexpr void feed(const screen::TouchReport &report) noexcept {
+    m_held = 0;
+    if (report.pen_up || report.x < 0 || report.y < 0) {
+      return;
+    }
+    const auto x{static_cast<uint32_t>(report.x)};
+    const auto y{static_cast<uint32_t>(report.y)};
+    for (size_t idx = 0; idx < m_count; ++idx) {
+      const auto &area{m_zones[idx].area};
+      if (x - area.x < area.width && y - area.y < area.height) {
+        m_held |= 1U << static_cast<uint32_t>(m_zones[idx].button);
+      }
+    }
+  }
+
+  /** @brief A bit per Button */
+  [[nodiscard]] constexpr uint32_t held() const noexcept { return m_held; }
+  [[nodiscard]] constexpr State state() const noexcept {
+    return to_state(m_held);
+  }
+
+  /** @brief The whole screen as a pad: a band across the top for up, one
+   * across the bottom for down, and the middle split left, etc, right. */
+  [[nodiscard]] static constexpr TouchPad dpad(screen::Dimensions size) noexcept {
+    const uint32_t band{size.height / 3};
+    const uint32_t col{size.width / 3};
+    const uint32_t mid_height{size.height - 2 * band};
+    TouchPad pad;
+    pad.add({.area = {.x = 0, .y = 0, .width = size.width, .height = band},
+             .button = Button::UP});
+    pad.add({.area = {.x = 0,
+                      .y = size.height - band,
+                      .width = size.width,
+                      .height = band},
+             .button = Button::DOWN});
+    pad.add({.area = {.x = 0, .y = band, .width = col, .height = mid_height},
+             .button = Button::LEFT});
+    pad.add({.area = {.x = col,
+                      .y = band,
+                      .width = size.width - 2 * col,
+                      .height = mid_height},
+             .button = Button::ETC});
+    pad.add({.area = {.x = size.width - col,
+                      .y = band,
+                      .width = col,
+                      .height = mid_height},
+             .button = Button::RIGHT});
+    return pad;
+  }
+
+private:
+  std::array<TouchZone, MAX_ZONES> m_zones{};
+  size_t m_count{0};
+  uint32_t m_held{0};
+};
+
+/** @brief Let get() also report the on-screen buttons of pad, or stop with
+ * nullptr.
+ *
+ *  get() then drains the touch report queue itself, at most
+ * TOUCH_PAD_REPORTS_PER_GET reports a call, so nothing else should be
+ * reading touch meanwhile.  pad must outlive its use.
+ */
+void set_touch_pad(TouchPad *pad) noexcept;
+[[nodiscard]] TouchPad *get_touch_pad() noexcept;
+
+} // namespace gamepad::five
+
+#endif
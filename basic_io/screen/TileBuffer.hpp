@@ -1,11 +1,15 @@
 #ifndef VIDEOBUF_HPP
 #define VIDEOBUF_HPP
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "TileDef.h"
+#include "gfx/defs.hpp"
 #include "tile_blitting.hpp"
 
 namespace {
@@ -47,6 +51,13 @@ public:
 
   explicit TileBuffer(buffer_type &buf) : video_buf{buf} {}
 
+  /** @return Whether a screen of width x height pixels has this buffer's row
+   * length, and at least its rows, so drawing here lands where it should. */
+  [[nodiscard]] static constexpr bool laid_out_for(size_t width,
+                                                   size_t height) {
+    return width == WIDTH_IN_PIXELS && height >= HEIGHT_IN_PIXELS;
+  }
+
   template <class TileT>
   [[nodiscard]] static constexpr size_t max_tiles_per_row() {
     return to_character_width<TileT>(WIDTH_IN_PIXELS, BPP);
@@ -107,37 +118,214 @@ public:
     }
   }
 
-  friend constexpr void scroll_left(TileBuffer &video_buf, size_t count) {
-    constexpr auto width{WIDTH_IN_PIXELS * BPP / 8};
-    const auto lookahead{count};
-    for (uint32_t rowidx = 0; rowidx < size(video_buf.video_buf);
-         rowidx += width) {
-      for (uint32_t idx = lookahead; idx < width; ++idx) {
-        video_buf.video_buf[idx - lookahead + rowidx] =
-            video_buf.video_buf[idx + rowidx];
+  /** @brief Move the contents of a region of the buffer by (dx, dy) pixels.
+   *
+   * Pixels moved in from outside the region are set to fill_value. Sub-byte
+   * horizontal moves are done a row at a time with 32-bit funnel shifts; byte
+   * aligned moves (and all vertical moves) reduce to memmove.
+   *
+   * @param dx Pixels to move right (negative moves left)
+   * @param dy Pixels to move down (negative moves up)
+   * @param fill_value Pixel value, in the buffer's native format
+   * @param region Area to scroll, in pixels.  Clamped to the buffer.
+   */
+  friend void scroll(TileBuffer &video_buf, int32_t dx, int32_t dy,
+                     uint32_t fill_value, screen::gfx::Rect region) {
+    if (region.topleft.x >= WIDTH_IN_PIXELS ||
+        region.topleft.y >= HEIGHT_IN_PIXELS) {
+      return;
+    }
+    const uint32_t x0{region.topleft.x};
+    const uint32_t y0{region.topleft.y};
+    const uint32_t width{std::min<uint32_t>(region.size.width, WIDTH_IN_PIXELS - x0)};
+    const uint32_t height{std::min<uint32_t>(region.size.height, HEIGHT_IN_PIXELS - y0)};
+    if (width == 0 || height == 0) {
+      return;
+    }
+
+    auto *const pbuf{std::data(video_buf.video_buf)};
+    const uint32_t absdx{static_cast<uint32_t>(dx < 0 ? -dx : dx)};
+    const uint32_t absdy{static_cast<uint32_t>(dy < 0 ? -dy : dy)};
+
+    if (absdx >= width || absdy >= height) {
+      for (uint32_t yy = y0; yy < y0 + height; ++yy) {
+        fill_span(row_of(pbuf, yy), x0, width, fill_value);
       }
-      for (uint32_t idx = width - lookahead; idx < width; ++idx) {
-        video_buf.video_buf[idx + rowidx] =
-            255; // TODO really need to abstract what is "white" and "black" for
-                 // the display
+      return;
+    }
+
+    /* whole rows moving vertically are one contiguous block */
+    if (dx == 0 && width == WIDTH_IN_PIXELS) {
+      const uint32_t keep{height - absdy};
+      const uint32_t dst_row{dy > 0 ? y0 + absdy : y0};
+      const uint32_t src_row{dy > 0 ? y0 : y0 + absdy};
+      memmove(row_of(pbuf, dst_row), row_of(pbuf, src_row), keep * PITCH);
+      const uint32_t fill_row{dy > 0 ? y0 : y0 + keep};
+      for (uint32_t yy = fill_row; yy < fill_row + absdy; ++yy) {
+        fill_span(row_of(pbuf, yy), 0, WIDTH_IN_PIXELS, fill_value);
       }
+      return;
     }
+
+    /* Rows are visited so that a source row is always read before it is
+     * overwritten. */
+    const uint32_t copy_width{width - absdx};
+    const uint32_t src_x{dx < 0 ? x0 + absdx : x0};
+    const uint32_t dst_x{dx > 0 ? x0 + absdx : x0};
+    const uint32_t fill_x{dx > 0 ? x0 : x0 + copy_width};
+    for (uint32_t idx = 0; idx < height; ++idx) {
+      const uint32_t yy{dy > 0 ? y0 + height - 1 - idx : y0 + idx};
+      const int32_t src_y{static_cast<int32_t>(yy) - dy};
+      auto *const p_row{row_of(pbuf, yy)};
+      if (src_y < static_cast<int32_t>(y0) ||
+          src_y >= static_cast<int32_t>(y0 + height)) {
+        fill_span(p_row, x0, width, fill_value);
+        continue;
+      }
+      copy_span(p_row, dst_x, row_of(pbuf, static_cast<uint32_t>(src_y)), src_x,
+                copy_width);
+      fill_span(p_row, fill_x, absdx, fill_value);
+    }
+  }
+
+  /** @brief Scroll the entire buffer. */
+  friend void scroll(TileBuffer &video_buf, int32_t dx, int32_t dy,
+                     uint32_t fill_value) {
+    scroll(video_buf, dx, dy, fill_value,
+           {.topleft = {.x = 0, .y = 0},
+            .size = {.width = WIDTH_IN_PIXELS, .height = HEIGHT_IN_PIXELS}});
+  }
+
+  /** @param count Number of bytes to scroll left */
+  friend void scroll_left(TileBuffer &video_buf, size_t count) {
+    scroll(video_buf, -static_cast<int32_t>(count * 8 / PIXEL_BITS), 0,
+           WHITE); // TODO really need to abstract what is "white" and "black"
+                   // for the display
   }
 
-  friend constexpr void scroll_up(TileBuffer &video_buf, size_t count) {
-    constexpr auto width{WIDTH_IN_PIXELS * BPP / 8};
-    const auto lookahead{width * count};
-    for (uint32_t idx = lookahead; idx < size(video_buf.video_buf); ++idx) {
-      video_buf.video_buf[idx - lookahead] = video_buf.video_buf[idx];
+  /** @param count Number of rows to scroll up */
+  friend void scroll_up(TileBuffer &video_buf, size_t count) {
+    scroll(video_buf, 0, -static_cast<int32_t>(count),
+           WHITE); // TODO really need to abstract what is "white" and "black"
+                   // for the display
+  }
+
+private:
+  static_assert(std::endian::native == std::endian::little,
+                "scroll's funnel shifts assume pixel 0 is the LSB of word 0");
+  static_assert(BPP == 1 || BPP == 2 || BPP == 4 || BPP == 8 || BPP == 16);
+
+  static constexpr uint32_t PIXEL_BITS{BPP};
+  static constexpr uint32_t PITCH{WIDTH_IN_PIXELS * PIXEL_BITS / 8};
+  static constexpr uint32_t WHITE{BPP == 16 ? 0xFFFFU
+                                            : (1U << PIXEL_BITS) - 1U};
+
+  [[nodiscard]] static uint8_t *row_of(uint8_t *pbuf, uint32_t row) noexcept {
+    return pbuf + row * PITCH;
+  }
+
+  /** @brief Set count pixels of a row, starting at pixel x, to value. */
+  static void fill_span(uint8_t *p_row, uint32_t x, uint32_t count,
+                        uint32_t value) noexcept {
+    if (count == 0) {
+      return;
     }
-    for (uint32_t idx = size(video_buf.video_buf) - lookahead;
-         idx < size(video_buf.video_buf); ++idx) {
-      video_buf.video_buf[idx] = 255; // TODO really need to abstract what is
-                                      // "white" and "black" for the display
+    if constexpr (BPP == 16) {
+      auto *p_pix{p_row + x * 2};
+      for (uint32_t idx = 0; idx < count; ++idx) {
+        *p_pix++ = value & 0xff;
+        *p_pix++ = (value >> 8) & 0xff;
+      }
+    } else {
+      uint8_t expanded{static_cast<uint8_t>(value & WHITE)};
+      for (uint32_t bits = PIXEL_BITS; bits < 8; bits <<= 1) {
+        expanded |= expanded << bits;
+      }
+      merge_bits(p_row, x * PIXEL_BITS, count * PIXEL_BITS, expanded);
+    }
+  }
+
+  /** @brief Write nbits of a repeating byte pattern at bit offset first_bit. */
+  static void merge_bits(uint8_t *p_row, uint32_t first_bit, uint32_t nbits,
+                         uint8_t pattern) noexcept {
+    auto *p_byte{p_row + (first_bit >> 3)};
+    const uint32_t head{first_bit & 7};
+    const uint32_t last{head + nbits};
+    if (last <= 8) {
+      const uint8_t mask{static_cast<uint8_t>(((1U << nbits) - 1U) << head)};
+      *p_byte = (*p_byte & ~mask) | (pattern & mask);
+      return;
+    }
+    if (head != 0) {
+      const uint8_t mask{static_cast<uint8_t>(0xFFU << head)};
+      *p_byte = (*p_byte & ~mask) | (pattern & mask);
+      ++p_byte;
+    }
+    const uint32_t whole{(last >> 3) - (head != 0 ? 1 : 0)};
+    memset(p_byte, pattern, whole);
+    p_byte += whole;
+    if (const uint32_t tail{last & 7}; tail != 0) {
+      const uint8_t mask{static_cast<uint8_t>((1U << tail) - 1U)};
+      *p_byte = (*p_byte & ~mask) | (pattern & mask);
+    }
+  }
+
+  /** @brief Copy count pixels from src_row[src_x] to dst_row[dst_x].
+   *
+   * The rows may be the same row, and the spans may overlap.
+   */
+  static void copy_span(uint8_t *dst_row, uint32_t dst_x,
+                        const uint8_t *src_row, uint32_t src_x,
+                        uint32_t count) noexcept {
+    const uint32_t nbits{count * PIXEL_BITS};
+    const uint32_t dst_bit{dst_x * PIXEL_BITS};
+    const uint32_t src_bit{src_x * PIXEL_BITS};
+    const uint32_t dst_head{dst_bit & 7};
+    const uint32_t src_head{src_bit & 7};
+    const uint32_t src_bytes{(src_head + nbits + 7) >> 3};
+
+    /* Stage the source bytes so overlapping spans in one row are safe, then
+     * funnel shift the staged words into the destination's bit phase. One
+     * spare word catches bits shifted out of the top. */
+    std::array<uint32_t, (PITCH + 3) / 4 + 2> staged{};
+    memcpy(std::data(staged), src_row + (src_bit >> 3), src_bytes);
+    const uint32_t nwords{(std::max(src_head, dst_head) + nbits + 31) >> 5};
+    if (dst_head > src_head) {
+      const uint32_t shift{dst_head - src_head};
+      for (uint32_t idx = nwords - 1; idx > 0; --idx) {
+        staged[idx] = (staged[idx] << shift) | (staged[idx - 1] >> (32 - shift));
+      }
+      staged[0] <<= shift;
+    } else if (src_head > dst_head) {
+      const uint32_t shift{src_head - dst_head};
+      for (uint32_t idx = 0; idx < nwords; ++idx) {
+        staged[idx] = (staged[idx] >> shift) | (staged[idx + 1] << (32 - shift));
+      }
+    }
+
+    /* merge, masking the partial bytes at either end */
+    const auto *p_src{reinterpret_cast<const uint8_t *>(std::data(staged))};
+    auto *p_dst{dst_row + (dst_bit >> 3)};
+    const uint32_t last{dst_head + nbits};
+    if (last <= 8) {
+      const uint8_t mask{static_cast<uint8_t>(((1U << nbits) - 1U) << dst_head)};
+      *p_dst = (*p_dst & ~mask) | (*p_src & mask);
+      return;
+    }
+    if (dst_head != 0) {
+      const uint8_t mask{static_cast<uint8_t>(0xFFU << dst_head)};
+      *p_dst = (*p_dst & ~mask) | (*p_src & mask);
+      ++p_dst;
+      ++p_src;
+    }
+    const uint32_t whole{(last >> 3) - (dst_head != 0 ? 1 : 0)};
+    memcpy(p_dst, p_src, whole);
+    if (const uint32_t tail{last & 7}; tail != 0) {
+      const uint8_t mask{static_cast<uint8_t>((1U << tail) - 1U)};
+      p_dst[whole] = (p_dst[whole] & ~mask) | (p_src[whole] & mask);
     }
   }
 
-private:
   buffer_type &video_buf;
 };
 
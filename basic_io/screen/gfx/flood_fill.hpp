@@ -0,0 +1,132 @@
+#if !defined(SCREEN_GFX_FLOOD_FILL_HPP)
+#define SCREEN_GFX_FLOOD_FILL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace screen::gfx {
+
+/** @brief One entry of the flood fill's work stack.
+ *
+ *  Columns [xl, xr] of row y have been filled; row y + dy still needs a look.
+ */
+struct FloodFillSpan {
+  int16_t y;
+  int16_t xl;
+  int16_t xr;
+  int16_t dy;
+};
+
+/** @brief Scanline seed fill (Heckbert's), over any pixel surface.
+ *
+ *  Replaces the 4-connected region of pixels matching the one at (x, y).
+ * Each run is found by reading pixels, then written with a single span fill,
+ * and every pixel is read a bounded number of times, so the work is linear
+ * in the area filled.  Memory is only the stack handed in.
+ *
+ * Surface needs:
+ *   uint32_t width() const, uint32_t height() const
+ *   uint32_t read(uint32_t x, uint32_t y) const
+ *   void fill(uint32_t y, uint32_t x_start, uint32_t x_finish, uint32_t value)
+ *     where x_finish is one past the last pixel.
+ *
+ * @param stack Scratch space.  A few dozen entries covers ordinary shapes;
+ * mazes want more.
+ * @param capacity Number of entries in stack.
+ *
+ * @return False if the stack ran out, in which case part of the region may be
+ * left unfilled.
+ */
+template <class Surface>
+[[nodiscard]] constexpr bool flood_fill(Surface &surface, uint32_t x,
+                                        uint32_t y, uint32_t value,
+                                        FloodFillSpan *stack,
+                                        size_t capacity) noexcept {
+  const auto width{static_cast<int32_t>(surface.width())};
+  const auto height{static_cast<int32_t>(surface.height())};
+  if (x >= surface.width() || y >= surface.height()) {
+    return true;
+  }
+  const uint32_t old_value{surface.read(x, y)};
+  if (old_value == value) {
+    return true;
+  }
+
+  size_t depth{0};
+  bool complete{true};
+  auto &&push{[&](int32_t row, int32_t xl, int32_t xr, int32_t dy) {
+    if (row + dy < 0 || row + dy >= height) {
+      return;
+    }
+    if (depth == capacity) {
+      complete = false;
+      return;
+    }
+    stack[depth++] = {.y = static_cast<int16_t>(row),
+                      .xl = static_cast<int16_t>(xl),
+                      .xr = static_cast<int16_t>(xr),
+                      .dy = static_cast<int16_t>(dy)};
+  }};
+  auto &&matches{[&](int32_t xx, int32_t row) {
+    return surface.read(static_cast<uint32_t>(xx),
+                        static_cast<uint32_t>(row)) == old_value;
+  }};
+
+  const auto seed_x{static_cast<int32_t>(x)};
+  const auto seed_y{static_cast<int32_t>(y)};
+  push(seed_y, seed_x, seed_x, 1);
+  push(seed_y + 1, seed_x, seed_x, -1); /* popped first, it is the seed row */
+
+  while (depth > 0) {
+    const auto entry{stack[--depth]};
+    const int32_t dy{entry.dy};
+    const int32_t row{entry.y + dy};
+    const int32_t x1{entry.xl};
+    const int32_t x2{entry.xr};
+
+    /* run left from x1; anything found there may leak back the other way */
+    int32_t xx{x1};
+    while (xx >= 0 && matches(xx, row)) {
+      --xx;
+    }
+    int32_t left;
+    if (xx < x1) {
+      left = xx + 1;
+      if (left < x1) {
+        push(row, left, x1 - 1, -dy);
+      }
+      xx = x1 + 1;
+    } else {
+      /* x1 itself is a boundary, go looking for the next run */
+      ++xx;
+      while (xx <= x2 && !matches(xx, row)) {
+        ++xx;
+      }
+      left = xx;
+    }
+
+    while (left <= x2) {
+      /* extend the run right, then fill it in one go */
+      while (xx < width && matches(xx, row)) {
+        ++xx;
+      }
+      surface.fill(static_cast<uint32_t>(row), static_cast<uint32_t>(left),
+                   static_cast<uint32_t>(xx), value);
+      push(row, left, xx - 1, dy);
+      if (xx > x2 + 1) {
+        push(row, x2 + 1, xx - 1, -dy);
+      }
+
+      /* skip the boundary to the next run under the parent span */
+      ++xx;
+      while (xx <= x2 && !matches(xx, row)) {
+        ++xx;
+      }
+      left = xx;
+    }
+  }
+  return complete;
+}
+
+} // namespace screen::gfx
+#endif
@@ -0,0 +1,230 @@
+#if !defined(SCREEN_GFX_LINE_WALK_HPP)
+#define SCREEN_GFX_LINE_WALK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "../screen_def.h"
+#include "defs.hpp"
+
+namespace screen::gfx {
+
+/** @brief A run of palette entries fading from background to a color.
+ *
+ *  Entry base is the background, entry base + levels - 1 the full color.
+ * In GREY formats the palette is fixed, and {0, 1 << bpp} is already a ramp.
+ */
+struct IntensityRamp {
+  uint32_t base;
+  uint32_t levels;
+};
+
+namespace details {
+
+/** @brief A Bresenham line, walked one step along its major axis at a time.
+ *
+ *  At step k the minor axis has moved m(k) = round(k * minor_len / major_len)
+ * (halves round up).  Rather than an error term that has to be run from the
+ * first pixel, the remainder of that division is kept, so the walk can be
+ * started at any step.
+ */
+struct LineWalk {
+  bool x_major;
+  int32_t x;
+  int32_t y;
+  int32_t minor_dir; /* +1 or -1; the major axis always increases */
+  int64_t major_len;
+  int64_t minor_len;
+  int64_t remainder; /* of (2 * k * minor_len + major_len) / (2 * major_len) */
+
+  /** @brief Jump ahead by k steps from the very first pixel */
+  constexpr void advance(int64_t k) noexcept {
+    const int64_t num{2 * k * minor_len + major_len};
+    const auto minor{static_cast<int32_t>(num / (2 * major_len))};
+    remainder = num % (2 * major_len);
+    if (x_major) {
+      x += static_cast<int32_t>(k);
+      y += minor_dir * minor;
+    } else {
+      y += static_cast<int32_t>(k);
+      x += minor_dir * minor;
+    }
+  }
+
+  /** @brief One step.  @return True if the minor axis moved as well. */
+  constexpr bool step() noexcept {
+    remainder += 2 * minor_len;
+    const bool minor_step{remainder >= 2 * major_len};
+    if (minor_step) {
+      remainder -= 2 * major_len;
+    }
+    if (x_major) {
+      ++x;
+      y += minor_step ? minor_dir : 0;
+    } else {
+      ++y;
+      x += minor_step ? minor_dir : 0;
+    }
+    return minor_step;
+  }
+};
+
+/** @brief Walk from whichever end has the smaller major coordinate */
+[[nodiscard]] constexpr LineWalk make_walk(Point p1, Point p2) noexcept {
+  auto &&abs64{[](int64_t v) { return v < 0 ? -v : v; }};
+  const bool x_major{abs64(static_cast<int64_t>(p1.y) - p2.y) <
+                     abs64(static_cast<int64_t>(p1.x) - p2.x)};
+  const auto major_of{[&](Point pt) { return x_major ? pt.x : pt.y; }};
+  if (major_of(p1) > major_of(p2)) {
+    std::swap(p1, p2);
+  }
+
+  LineWalk walk{};
+  walk.x_major = x_major;
+  walk.x = static_cast<int32_t>(p1.x);
+  walk.y = static_cast<int32_t>(p1.y);
+  const int64_t dminor{x_major ? static_cast<int64_t>(p2.y) - p1.y
+                               : static_cast<int64_t>(p2.x) - p1.x};
+  walk.minor_dir = dminor < 0 ? -1 : 1;
+  walk.major_len = x_major ? p2.x - p1.x : p2.y - p1.y;
+  walk.minor_len = abs64(dminor);
+  return walk;
+}
+
+[[nodiscard]] constexpr int64_t floor_div(int64_t num, int64_t den) noexcept {
+  return num / den - ((num % den != 0) && (num < 0) ? 1 : 0);
+}
+[[nodiscard]] constexpr int64_t ceil_div(int64_t num, int64_t den) noexcept {
+  return -floor_div(-num, den);
+}
+
+struct StepRange {
+  int64_t first;
+  int64_t last; /* one past */
+};
+
+/** @brief Which steps of a fresh walk land within margin of the screen.
+ *
+ *  Liang-Barsky, but in whole steps: the major axis bounds the steps
+ * directly, and since m(k) never decreases the minor axis bounds can be
+ * inverted exactly.  Clipping never changes which pixels the line covers.
+ * The end point itself is not drawn.
+ */
+[[nodiscard]] constexpr StepRange clip_steps(const LineWalk &walk,
+                                             Dimensions dim,
+                                             int32_t margin) noexcept {
+  const int64_t major0{walk.x_major ? walk.x : walk.y};
+  const int64_t minor0{walk.x_major ? walk.y : walk.x};
+  const int64_t major_hi{
+      static_cast<int64_t>(walk.x_major ? dim.width : dim.height) - 1 + margin};
+  const int64_t minor_hi{
+      static_cast<int64_t>(walk.x_major ? dim.height : dim.width) - 1 + margin};
+  const int64_t lo{-margin};
+
+  StepRange rv{.first = std::max<int64_t>(0, lo - major0),
+               .last = std::min<int64_t>(walk.major_len,
+                                         major_hi - major0 + 1)};
+
+  /* minor offsets allowed, m(k) in [a, b] */
+  const int64_t a{walk.minor_dir > 0 ? lo - minor0 : minor0 - minor_hi};
+  const int64_t b{walk.minor_dir > 0 ? minor_hi - minor0 : minor0 - lo};
+  const int64_t big_d{walk.major_len};
+  const int64_t small_d{walk.minor_len};
+  if (small_d == 0) {
+    if (a > 0 || b < 0) {
+      rv.last = rv.first;
+    }
+    return rv;
+  }
+  /* m(k) >= a  <=>  2k*d + D >= 2D*a
+   * m(k) <= b  <=>  2k*d + D < 2D*(b + 1) */
+  rv.first = std::max(rv.first, ceil_div(2 * big_d * a - big_d, 2 * small_d));
+  rv.last = std::min(rv.last,
+                     floor_div(2 * big_d * (b + 1) - big_d - 1, 2 * small_d) +
+                         1);
+  return rv;
+}
+
+/** @brief Xiaolin Wu's line, count steps of an already clipped walk.
+ *
+ *  The exact minor coordinate is carried in 16.16 fixed point.  Its fraction
+ * splits the step's coverage between the pixel on either side of the line,
+ * and is scaled to ramp levels with one multiply.  The walk only supplies the
+ * starting point, as it knows the exact position at any step.
+ *
+ * @param p_frame Packed pixels, dim.width * BPP / 8 bytes a row.
+ */
+template <uint32_t BPP>
+constexpr void wu_line(uint8_t *p_frame, const LineWalk &walk, int64_t count,
+                       Dimensions dim, IntensityRamp ramp) noexcept {
+  constexpr uint32_t ONE{1U << 16};
+  const uint32_t pitch{dim.width * BPP / 8};
+  const uint32_t mask{(1U << BPP) - 1};
+  const uint32_t top{ramp.levels - 1};
+
+  auto &&plot{[&](uint32_t x, uint32_t y, uint32_t level) {
+    if (x >= dim.width || y >= dim.height || (level == 0 && top != 0)) {
+      return;
+    }
+    const uint32_t bit{x * BPP};
+    uint8_t &byte{p_frame[y * pitch + (bit >> 3)]};
+    const uint32_t shift{bit & 7};
+    /* already as bright, or brighter? unsigned, so anything below base is
+     * out of the ramp too */
+    const uint32_t current{((byte >> shift) & mask) - ramp.base};
+    if (current < ramp.levels && current >= level) {
+      return;
+    }
+    byte = static_cast<uint8_t>((byte & ~(mask << shift)) |
+                                (((ramp.base + level) & mask) << shift));
+  }};
+
+  /* the walk sits at round(k * d / D), and its remainder says by how much */
+  const int32_t major0{walk.x_major ? walk.x : walk.y};
+  const int32_t minor0{walk.x_major ? walk.y : walk.x};
+  const auto frac{static_cast<int32_t>(
+      (walk.remainder << 16) / (2 * walk.major_len) - ONE / 2)};
+  int32_t minor{static_cast<int32_t>(static_cast<uint32_t>(minor0) << 16) +
+                walk.minor_dir * frac};
+  const auto gradient{static_cast<int32_t>(
+      walk.minor_dir *
+      (((walk.minor_len << 16) + walk.major_len / 2) / walk.major_len))};
+
+  for (int32_t idx = 0; idx < count; ++idx) {
+    const auto major{static_cast<uint32_t>(major0 + idx)};
+    const auto near{static_cast<uint32_t>(minor >> 16)};
+    const uint32_t far_level{((minor & (ONE - 1)) * top + ONE / 2) >> 16};
+    if (walk.x_major) {
+      plot(major, near, top - far_level);
+      plot(major, near + 1, far_level);
+    } else {
+      plot(near, major, top - far_level);
+      plot(near + 1, major, far_level);
+    }
+    minor += gradient;
+  }
+}
+
+/** @brief draw_line_aa() from p1 to p2, into any packed framebuffer of dim.
+ */
+template <uint32_t BPP>
+constexpr void draw_wu_line(uint8_t *p_frame, Point p1, Point p2,
+                            Dimensions dim, IntensityRamp ramp) noexcept {
+  if (ramp.levels == 0 || (p1.x == p2.x && p1.y == p2.y)) {
+    return;
+  }
+  auto walk{make_walk(p1, p2)};
+  /* the far pixel of a step can be one past the walk's */
+  const auto steps{clip_steps(walk, dim, 1)};
+  if (steps.first >= steps.last) {
+    return;
+  }
+  walk.advance(steps.first);
+  wu_line<BPP>(p_frame, walk, steps.last - steps.first, dim, ramp);
+}
+
+} // namespace details
+} // namespace screen::gfx
+
+#endif
@@ -1,75 +1,215 @@
 #include "shapes.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 
 #include "../screen.hpp"
 
 namespace screen::gfx {
 
 namespace details {
-/**
- Preconditions: xstart < xstop
-                xstart and xstop are within image bounds
- */
+/** @brief [xstart, xstop) on row ypos, clipped to the screen */
 static inline void handle_horizontal_line_case(uint32_t xstart, uint32_t xstop,
                                                uint32_t ypos,
                                                uint32_t value) noexcept {
-  /* we might be misaligned, i.e. not on a byte boundary
-   * in which case, we can
-   *    check for misalignment, both at the start and the end
-   *    apply the update to the misaligned byte at the start
-   *    memset the middle
-   *    apply the update to the misaligned byte at the end
-   */
+  screen::fillspan(value, ypos, xstart, xstop);
+}
 
-  const auto fmt{screen::get_format()};
-  const auto dim{screen::get_virtual_screen_size()};
-  const auto rowstart{ypos * dim.width};
+/** @brief Fill [x0, x1] on row y, where any of them may be off screen */
+static inline void fill_clipped_span(int32_t x0, int32_t x1, int32_t y,
+                                     uint32_t value) noexcept {
+  if (y < 0 || x1 < 0 || x1 < x0) {
+    return;
+  }
+  screen::fillspan(value, static_cast<uint32_t>(y),
+                   static_cast<uint32_t>(std::max(x0, 0)),
+                   static_cast<uint32_t>(x1) + 1U);
+}
 
-  auto *p_buf{screen::get_video_buffer()};
+/** @brief Midpoint half-width of a disc, one row at a time.
+ *
+ *  A pixel (x, y) is inside when x*x + y*y <= r*r + r, i.e. closer to the
+ * center than r + 1/2.  Rows are asked for in increasing order, so x only ever
+ * steps down, and never needs a square root.
+ */
+class DiscStepper {
+public:
+  explicit constexpr DiscStepper(int32_t radius) noexcept
+      : m_limit{radius * radius + radius}, m_x{radius} {}
 
-  /* test for, and handle, byte-aligned formats */
-  if (fmt == screen::Format::RGB565) {
-    for (int idx = xstart + rowstart; idx < xstop + rowstart; idx += 2) {
-      const auto linidx{screen::align_byte(idx, screen::Format::RGB565)};
-      p_buf[linidx] = value & 0xFFU;
-      p_buf[linidx + 1] = (value >> 8) & 0xFFU;
+  /** @return Half-width at row dy, or -1 if the row misses the disc */
+  [[nodiscard]] constexpr int32_t half_width(int32_t dy) noexcept {
+    const int32_t dy2{dy * dy};
+    while (m_x >= 0 && m_x * m_x + dy2 > m_limit) {
+      --m_x;
     }
-    return;
+    return m_x;
   }
-  if (fmt == screen::Format::RGB565_LUT8) {
-    memset(&p_buf[xstart], value, xstop - xstart);
-    return;
+
+private:
+  int32_t m_limit;
+  int32_t m_x;
+};
+
+/** @brief A polygon edge, walked one scanline at a time in S18.14 */
+struct ScanEdge {
+  int32_t ystart; /* first scanline crossed */
+  int32_t ystop;  /* one past the last */
+  int32_t x;      /* where the current scanline's center crosses */
+  int32_t slope;  /* change in x per scanline */
+};
+
+inline constexpr int32_t FRAC_BITS{14};
+inline constexpr int32_t HALF{1 << (FRAC_BITS - 1)};
+
+/** @brief First pixel whose center is at or right of x */
+[[nodiscard]] constexpr int32_t first_covered(int32_t x) noexcept {
+  return (x + HALF - 1) >> FRAC_BITS;
+}
+
+/** @brief The live framebuffer, as flood_fill wants to see it.
+ *
+ *  Format, size and pitch are looked up once, not on every read like peek.
+ */
+class ScreenSurface {
+public:
+  ScreenSurface() noexcept
+      : m_fmt{screen::get_format()}, m_dim{screen::get_virtual_screen_size()},
+        m_bpp{static_cast<uint32_t>(screen::bitsizeof(m_fmt))},
+        m_pitch{m_dim.width * m_bpp / 8},
+        m_p_frame{screen::get_video_buffer()} {}
+
+  [[nodiscard]] uint32_t width() const noexcept { return m_dim.width; }
+  [[nodiscard]] uint32_t height() const noexcept { return m_dim.height; }
+
+  [[nodiscard]] uint32_t read(uint32_t x, uint32_t y) const noexcept {
+    const uint8_t *p_row{m_p_frame + y * m_pitch};
+    if (m_bpp == 16) {
+      return p_row[x << 1] | (p_row[(x << 1) + 1] << 8);
+    }
+    const uint32_t bit{x * m_bpp};
+    return (p_row[bit >> 3] >> (bit & 7)) & ((1U << m_bpp) - 1);
+  }
+
+  void fill(uint32_t y, uint32_t x_start, uint32_t x_finish,
+            uint32_t value) const noexcept {
+    screen::fillspan(value, y, x_start, x_finish);
   }
 
-  /* OTHERWISE, handle the non-byte aligned formats */
-  const auto byte_value{screen::expand(value, fmt)};
-  if (screen::subbyte_index(xstart + rowstart, fmt) != 0) {
-    screen::poke(xstart, ypos, value);
-    ++xstart;
+private:
+  screen::Format m_fmt;
+  Dimensions m_dim;
+  uint32_t m_bpp;
+  uint32_t m_pitch;
+  const uint8_t *m_p_frame;
+};
+
+/** @brief Draw count pixels of a clipped, one pixel wide line.
+ *
+ *  The byte pointer and bit shift are stepped directly: a step along x moves
+ * the shift by BPP bits, a step along y moves the pointer by the row pitch.
+ */
+template <uint32_t BPP>
+static void step_line(LineWalk walk, int64_t count, Dimensions dim,
+                      uint32_t value) noexcept {
+  const uint32_t pitch{dim.width * BPP / 8};
+  const uint32_t mask{BPP == 16 ? 0xFFFFU : (1U << BPP) - 1};
+  value &= mask;
+
+  const uint32_t bit{static_cast<uint32_t>(walk.x) * BPP};
+  uint8_t *p_pix{screen::get_video_buffer() +
+                 static_cast<uint32_t>(walk.y) * pitch + (bit >> 3)};
+  uint32_t shift{bit & 7};
+
+  auto &&step_x{[&](int32_t dir) {
+    if constexpr (BPP >= 8) {
+      p_pix += dir * static_cast<int32_t>(BPP / 8);
+    } else if (dir > 0) {
+      shift += BPP;
+      if (shift == 8) {
+        shift = 0;
+        ++p_pix;
+      }
+    } else if (shift == 0) {
+      shift = 8 - BPP;
+      --p_pix;
+    } else {
+      shift -= BPP;
+    }
+  }};
+  const int32_t minor_pitch{walk.minor_dir * static_cast<int32_t>(pitch)};
+
+  for (int64_t idx = 0; idx < count; ++idx) {
+    if constexpr (BPP == 16) {
+      p_pix[0] = value & 0xFF;
+      p_pix[1] = (value >> 8) & 0xFF;
+    } else if constexpr (BPP == 8) {
+      *p_pix = static_cast<uint8_t>(value);
+    } else {
+      *p_pix = static_cast<uint8_t>((*p_pix & ~(mask << shift)) |
+                                    (value << shift));
+    }
+
+    const bool minor_step{walk.step()};
+    if (walk.x_major) {
+      step_x(1);
+      if (minor_step) {
+        p_pix += minor_pitch;
+      }
+    } else {
+      p_pix += pitch;
+      if (minor_step) {
+        step_x(walk.minor_dir);
+      }
+    }
   }
-  xstart = screen::align_byte(xstart + rowstart, fmt);
+}
 
-  if (screen::subbyte_index(xstop + rowstart, fmt) != 0) {
-    screen::poke(xstop - 1, ypos, value);
-    --xstop;
+/** @brief Thick lines, as horizontal spans.
+ *
+ *  Steep lines get one span per row, thickness pixels wide.  Shallow lines
+ * have each horizontal run of the center line repeated over thickness rows.
+ */
+static void draw_thick_line(LineWalk walk, int64_t count, uint32_t value,
+                            uint32_t thickness) noexcept {
+  const auto half{static_cast<int32_t>(thickness / 2)};
+  const auto width{static_cast<int32_t>(thickness)};
+
+  if (!walk.x_major) {
+    for (int64_t idx = 0; idx < count; ++idx) {
+      fill_clipped_span(walk.x - half, walk.x - half + width - 1, walk.y,
+                        value);
+      static_cast<void>(walk.step());
+    }
+    return;
   }
-  xstop = screen::align_byte(xstop + rowstart, fmt);
 
-  if (xstart < xstop) {
-    memset(&p_buf[xstart], byte_value, xstop - xstart);
+  auto &&emit_run{[&](int32_t x0, int32_t x1, int32_t y) {
+    for (int32_t row = y - half; row < y - half + width; ++row) {
+      fill_clipped_span(x0, x1, row, value);
+    }
+  }};
+  int32_t run_start{walk.x};
+  for (int64_t idx = 0; idx < count; ++idx) {
+    const int32_t x{walk.x};
+    const int32_t y{walk.y};
+    const bool minor_step{walk.step()};
+    if (minor_step || idx + 1 == count) {
+      emit_run(run_start, x, y);
+      run_start = walk.x;
+    }
   }
 }
 
+/** @brief [ystart, ystop) on column xpos, clipped to the screen */
 static inline void handle_vertical_line_case(uint32_t ystart, uint32_t ystop,
                                              uint32_t xpos,
                                              uint32_t value) noexcept {
-  while (ystart != ystop) {
-    screen::poke(xpos, ystart++, value);
-  }
+  screen::fillcolumn(value, xpos, ystart, ystop);
 }
 
 } // namespace details
@@ -115,71 +255,86 @@ void draw_line(Point p1, Point p2, uint32_t value,
   }
 
   /* not the easy cases?  Then Bresenham's it is!
+   *
+   * Walk the major axis (the one that changes faster) in increasing order, so
+   * a line and its reverse cover the same pixels.  Clip to the screen first,
+   * then either step straight through the framebuffer or, when thick, emit
+   * spans.
+   */
+  auto walk{details::make_walk(p1, p2)};
 
-    need to check which axis is minor(changes slower) and which is major(changes
-    faster)
-      most examples have the Y axis as minor and the X axis as major
+  /* thick lines may poke onto the screen from just outside of it */
+  const auto margin{static_cast<int32_t>(thickness > 1 ? thickness : 0)};
+  const auto steps{details::clip_steps(walk, dim, margin)};
+  if (steps.first >= steps.last) {
+    return;
+  }
+  walk.advance(steps.first);
 
-    need to check if the minor axis needs to increase or decrease
-      most examples have the minor axis increasing
-      *
-   */
-  const bool y_is_minor{std::abs(static_cast<int>(p1.y - p2.y)) <
-                        std::abs(static_cast<int>(p1.x - p2.x))};
-
-  if (y_is_minor) {
-    const auto startx{std::min(p1.x, p2.x)};
-    const auto stopx{std::max(p1.x, p2.x)};
-    const auto starty{static_cast<int16_t>(p1.x < p2.x ? p1.y : p2.y)};
-    const auto stopy{static_cast<int16_t>(p1.x < p2.x ? p2.y : p1.y)};
-
-    int16_t deltax{stopx - startx};
-    int16_t deltay{stopy - starty};
-
-    int16_t yi = 1;
-    if (deltay < 0) {
-      yi = -1;
-      deltay = -deltay;
-    }
-
-    int16_t error{static_cast<int16_t>((deltay << 1) - deltax)};
-    int16_t yy{starty};
-    for (uint16_t xx = startx; xx < stopx; ++xx) {
-      screen::poke(xx, yy, value);
-      if (error > 0) {
-        yy += yi;
-        error = error + (2 * (deltay - deltax));
-      } else {
-        error = error + 2 * deltay;
-      }
-    }
-  } else {
-    /* X is the minor axis */
-    const auto starty{std::min(p1.y, p2.y)};
-    const auto stopy{std::max(p1.y, p2.y)};
-    const auto startx{static_cast<int16_t>(p1.y < p2.y ? p1.x : p2.x)};
-    const auto stopx{static_cast<int16_t>(p1.y < p2.y ? p2.x : p1.x)};
-
-    int16_t deltax{stopx - startx};
-    int16_t deltay{stopy - starty};
-
-    int16_t xi = 1;
-    if (deltax < 0) {
-      xi = -1;
-      deltax = -deltax;
-    }
-
-    int16_t error{static_cast<int16_t>((deltax << 1) - deltay)};
-    int16_t xx{startx};
-    for (uint16_t yy = starty; yy < stopy; ++yy) {
-      screen::poke(xx, yy, value);
-      if (error > 0) {
-        xx += xi;
-        error += ((deltax - deltay) << 1);
-      } else {
-        error += deltax << 1;
-      }
+  if (thickness > 1) {
+    details::draw_thick_line(walk, steps.last - steps.first, value,
+                             thickness);
+    return;
+  }
+
+  switch (screen::get_format()) {
+  case screen::Format::GREY1:
+    details::step_line<1>(walk, steps.last - steps.first, dim, value);
+    break;
+  case screen::Format::GREY2:
+  case screen::Format::RGB565_LUT2:
+    details::step_line<2>(walk, steps.last - steps.first, dim, value);
+    break;
+  case screen::Format::GREY4:
+  case screen::Format::RGB565_LUT4:
+    details::step_line<4>(walk, steps.last - steps.first, dim, value);
+    break;
+  case screen::Format::RGB565_LUT8:
+    details::step_line<8>(walk, steps.last - steps.first, dim, value);
+    break;
+  case screen::Format::RGB565:
+    details::step_line<16>(walk, steps.last - steps.first, dim, value);
+    break;
+  }
+}
+
+IntensityRamp load_intensity_ramp(Clut *palette, uint32_t length,
+                                  uint32_t base, uint32_t levels,
+                                  Clut background, Clut foreground) noexcept {
+  /* written so that base + levels can't wrap */
+  if (base >= length || levels > length - base) {
+    return {.base = base, .levels = 0};
+  }
+  const auto ramp{
+      build_intensity_ramp(palette, base, levels, background, foreground)};
+  screen::init_clut(palette, length);
+  return ramp;
+}
+
+void draw_line_aa(Point p1, Point p2, IntensityRamp ramp) noexcept {
+  const auto dim{screen::get_virtual_screen_size()};
+  uint8_t *const p_frame{screen::get_video_buffer()};
+
+  switch (screen::get_format()) {
+  case screen::Format::GREY1:
+    details::draw_wu_line<1>(p_frame, p1, p2, dim, ramp);
+    break;
+  case screen::Format::GREY2:
+  case screen::Format::RGB565_LUT2:
+    details::draw_wu_line<2>(p_frame, p1, p2, dim, ramp);
+    break;
+  case screen::Format::GREY4:
+  case screen::Format::RGB565_LUT4:
+    details::draw_wu_line<4>(p_frame, p1, p2, dim, ramp);
+    break;
+  case screen::Format::RGB565_LUT8:
+    details::draw_wu_line<8>(p_frame, p1, p2, dim, ramp);
+    break;
+  case screen::Format::RGB565:
+    if (ramp.levels != 0 && (p1.x != p2.x || p1.y != p2.y)) {
+      draw_line(p1, p2, ramp.base + ramp.levels - 1, 1);
     }
+    break;
   }
 }
 
@@ -191,8 +346,9 @@ void draw_line(Point p1, Point p2, uint32_t value,
  */
 void draw_rect(Rect r, uint32_t value, uint32_t thickness) noexcept {
   if (thickness == 0) {
-    screen::fillrows(value, r.topleft.y, r.size.height, r.topleft.x,
-                     r.size.width);
+    for (uint32_t yy = r.topleft.y; yy < r.topleft.y + r.size.height; ++yy) {
+      screen::fillspan(value, yy, r.topleft.x, r.topleft.x + r.size.width);
+    }
     return;
   }
 
@@ -216,5 +372,140 @@ void draw_rect(Rect r, uint32_t value, uint32_t thickness) noexcept {
  * @param thickenss Border thickness.  A value of '0' means 'filled'.
  */
 void draw_circle(Point center, uint32_t radius, uint32_t value,
-                 uint32_t thickness) noexcept {}
-} // namespace screen::gfx
\ No newline at end of file
+                 uint32_t thickness) noexcept {
+  /* outline = disc of radius minus the disc of (radius - thickness), so every
+   * row is at most two spans and there are never gaps between octants */
+  const auto r{static_cast<int32_t>(radius)};
+  const bool filled{thickness == 0 || thickness > radius};
+  const int32_t inner_r{filled ? -1 : r - static_cast<int32_t>(thickness)};
+  const auto cx{static_cast<int32_t>(center.x)};
+  const auto cy{static_cast<int32_t>(center.y)};
+
+  details::DiscStepper outer{r};
+  details::DiscStepper inner{std::max(inner_r, 0)};
+  for (int32_t dy = 0; dy <= r; ++dy) {
+    const int32_t outer_hw{outer.half_width(dy)};
+    const int32_t inner_hw{dy <= inner_r ? inner.half_width(dy) : -1};
+
+    auto &&emit{[&](int32_t y) {
+      if (inner_hw < 0) {
+        details::fill_clipped_span(cx - outer_hw, cx + outer_hw, y, value);
+      } else {
+        details::fill_clipped_span(cx - outer_hw, cx - inner_hw - 1, y, value);
+        details::fill_clipped_span(cx + inner_hw + 1, cx + outer_hw, y, value);
+      }
+    }};
+    emit(cy - dy);
+    if (dy != 0) {
+      emit(cy + dy);
+    }
+  }
+}
+
+/** @brief Draw a round dot on the screen
+ * @param center of the dot
+ * @param value Color value.  Will be interpreted using the screen's current
+ * format.
+ * @param diameter Of the dot, in pixels.  '1' is a single pixel.
+ */
+void draw_point(Point center, uint32_t value, uint32_t diameter) noexcept {
+  draw_circle(center, diameter / 2, value, 0);
+}
+
+/** @brief Fill a polygon, convex or not.
+ *
+ *  Vertices are pixel corners, and a pixel is filled when its center is
+ * inside (even-odd rule).  So polygons that share an edge never overlap or
+ * leave a gap between them.
+ *
+ * @param vertices In order around the outline; the last joins back to the
+ * first.
+ * @param count Number of vertices.  Fewer than 3 draws nothing.
+ * @param value Color value.  Will be interpreted using the screen's current
+ * format.
+ */
+void fill_polygon(const Point *vertices, size_t count,
+                  uint32_t value) noexcept {
+  using details::FRAC_BITS;
+
+  count = std::min(count, MAX_POLYGON_VERTICES);
+  if (count < 3) {
+    return;
+  }
+
+  /* build the edge list; horizontal edges never cross a scanline center */
+  std::array<details::ScanEdge, MAX_POLYGON_VERTICES> edges;
+  size_t edge_count{0};
+  int32_t ymin{std::numeric_limits<int32_t>::max()};
+  int32_t ymax{std::numeric_limits<int32_t>::min()};
+  for (size_t idx = 0; idx < count; ++idx) {
+    Point top{vertices[idx]};
+    Point bottom{vertices[(idx + 1) % count]};
+    if (top.y == bottom.y) {
+      continue;
+    }
+    if (top.y > bottom.y) {
+      std::swap(top, bottom);
+    }
+    const auto dx{static_cast<int32_t>(bottom.x) - static_cast<int32_t>(top.x)};
+    const auto dy{static_cast<int32_t>(bottom.y - top.y)};
+    const int32_t slope{(dx * (1 << FRAC_BITS)) / dy};
+    edges[edge_count++] = {.ystart = static_cast<int32_t>(top.y),
+                           .ystop = static_cast<int32_t>(bottom.y),
+                           .x = (static_cast<int32_t>(top.x) << FRAC_BITS) +
+                                slope / 2,
+                           .slope = slope};
+    ymin = std::min(ymin, static_cast<int32_t>(top.y));
+    ymax = std::max(ymax, static_cast<int32_t>(bottom.y));
+  }
+  if (edge_count == 0) {
+    return;
+  }
+  ymax = std::min(ymax,
+                  static_cast<int32_t>(screen::get_virtual_screen_size().height));
+
+  /* each scanline: gather the crossings, sort them, fill between pairs */
+  std::array<int32_t, MAX_POLYGON_VERTICES> crossings;
+  for (int32_t yy = ymin; yy < ymax; ++yy) {
+    size_t crossing_count{0};
+    for (size_t idx = 0; idx < edge_count; ++idx) {
+      auto &edge{edges[idx]};
+      if (yy < edge.ystart || yy >= edge.ystop) {
+        continue;
+      }
+      /* insertion sort, there are only ever a handful */
+      size_t pos{crossing_count++};
+      while (pos > 0 && crossings[pos - 1] > edge.x) {
+        crossings[pos] = crossings[pos - 1];
+        --pos;
+      }
+      crossings[pos] = edge.x;
+      edge.x += edge.slope;
+    }
+    for (size_t idx = 0; idx + 1 < crossing_count; idx += 2) {
+      details::fill_clipped_span(details::first_covered(crossings[idx]),
+                                 details::first_covered(crossings[idx + 1]) -
+                                     1,
+                                 yy, value);
+    }
+  }
+}
+
+/** @brief Fill the region of like-colored pixels around a point.
+ *
+ * @return False if the stack ran out and the fill may be incomplete.
+ */
+bool flood_fill(Point seed, uint32_t value, FloodFillSpan *stack,
+                size_t capacity) noexcept {
+  details::ScreenSurface surface{};
+  const auto bpp{screen::bitsizeof(screen::get_format())};
+  const uint32_t mask{bpp == 16 ? 0xFFFFU : (1U << bpp) - 1};
+  return flood_fill(surface, seed.x, seed.y, value & mask, stack, capacity);
+}
+
+/** @brief Fill a triangle.  Same rules as fill_polygon. */
+void fill_triangle(Point p1, Point p2, Point p3, uint32_t value) noexcept {
+  const std::array<Point, 3> vertices{p1, p2, p3};
+  fill_polygon(std::data(vertices), std::size(vertices), value);
+}
+} // namespace screen::gfx
@@ -1,7 +1,11 @@
 #if !defined(SCREEN_GFX_SHAPES_HPP)
 #define SCREEN_GFX_SHAPES_HPP
 
+#include "../screen_def.h"
 #include "defs.hpp"
+#include "flood_fill.hpp"
+#include "line_walk.hpp"
+#include <cstddef>
 #include <cstdint>
 
 namespace screen::gfx {
@@ -14,6 +18,59 @@ namespace screen::gfx {
  */
 void draw_line(Point p1, Point p2, uint32_t value, uint32_t thickness) noexcept;
 
+/** @brief Fill in palette[base, base + levels) as a linear fade.
+ *
+ *  The caller owns the palette.  This only writes the ramp entries, so the
+ * rest of it can be set up before or after.
+ *
+ * @pre palette has at least base + levels entries.  Nothing here checks;
+ * load_intensity_ramp() does.
+ */
+constexpr IntensityRamp build_intensity_ramp(Clut *palette, uint32_t base,
+                                             uint32_t levels, Clut background,
+                                             Clut foreground) noexcept {
+  const uint32_t top{levels > 1 ? levels - 1 : 1};
+  auto &&mix{[&](uint8_t from, uint8_t to, uint32_t level) {
+    return static_cast<uint8_t>((from * (top - level) + to * level + top / 2) /
+                                top);
+  }};
+  for (uint32_t level = 0; level < levels; ++level) {
+    palette[base + level] = {.r = mix(background.r, foreground.r, level),
+                             .g = mix(background.g, foreground.g, level),
+                             .b = mix(background.b, foreground.b, level)};
+  }
+  return {.base = base, .levels = levels};
+}
+
+/** @brief build_intensity_ramp(), then hand the whole palette to
+ * screen::init_clut().
+ *
+ * @param length Entries in palette, all of which are loaded.
+ *
+ * @return The ramp, or one with no levels, drawing nothing, if it would not
+ * fit in palette.  Then neither palette nor the screen is touched.
+ */
+IntensityRamp load_intensity_ramp(Clut *palette, uint32_t length,
+                                  uint32_t base, uint32_t levels,
+                                  Clut background, Clut foreground) noexcept;
+
+/** @brief Draw an anti-aliased, one pixel wide line (Xiaolin Wu's).
+ *
+ *  Each step along the major axis lights the two pixels straddling the line,
+ * with ramp levels in proportion to how close the line passes.  There is no
+ * blending with what is underneath; instead a pixel already showing a
+ * brighter level of the same ramp keeps it, so lines can cross and share end
+ * points.  Like draw_line(), the end point p2 is not drawn.
+ *
+ * Needs a format with at most 8 bits per pixel.  In RGB565 this draws a plain
+ * line in base + levels - 1.
+ *
+ * @param ramp Where the line's levels live in the palette.  A ramp with a
+ * single level paints every pixel the line touches with base, which is how to
+ * erase one.
+ */
+void draw_line_aa(Point p1, Point p2, IntensityRamp ramp) noexcept;
+
 /** @brief Draw a rectangle on the screen
  * @param rect Rectangle definition.
  * @param value Color value.  Will be interpreted using the screen's current
@@ -31,5 +88,48 @@ void draw_rect(Rect r, uint32_t value, uint32_t thickness) noexcept;
  */
 void draw_circle(Point center, uint32_t radius, uint32_t value,
                  uint32_t thickness) noexcept;
+
+/** @brief Draw a round dot on the screen
+ * @param center of the dot
+ * @param value Color value.  Will be interpreted using the screen's current
+ * format.
+ * @param diameter Of the dot, in pixels.  '1' is a single pixel.
+ */
+void draw_point(Point center, uint32_t value, uint32_t diameter) noexcept;
+
+/** @brief Most vertices fill_polygon will take.  Extras are ignored. */
+inline constexpr size_t MAX_POLYGON_VERTICES{16};
+
+/** @brief Fill a polygon, convex or not.
+ *
+ *  Vertices are pixel corners, and a pixel is filled when its center is
+ * inside (even-odd rule).  So polygons that share an edge never overlap or
+ * leave a gap between them.
+ *
+ * @param vertices In order around the outline; the last joins back to the
+ * first.
+ * @param count Number of vertices.  Fewer than 3 draws nothing.
+ * @param value Color value.  Will be interpreted using the screen's current
+ * format.
+ */
+void fill_polygon(const Point *vertices, size_t count, uint32_t value) noexcept;
+
+/** @brief Fill a triangle.  Same rules as fill_polygon. */
+void fill_triangle(Point p1, Point p2, Point p3, uint32_t value) noexcept;
+
+/** @brief Fill the region of like-colored pixels around a point.
+ *
+ *  4-connected, any screen format.  See flood_fill() in flood_fill.hpp.
+ *
+ * @param seed Any pixel in the region
+ * @param value Color value.  Will be interpreted using the screen's current
+ * format.
+ * @param stack Scratch space, no heap is used
+ * @param capacity Number of entries in stack
+ *
+ * @return False if the stack ran out and the fill may be incomplete.
+ */
+[[nodiscard]] bool flood_fill(Point seed, uint32_t value, FloodFillSpan *stack,
+                              size_t capacity) noexcept;
 } // namespace screen::gfx
 #endif
\ No newline at end of file
@@ -0,0 +1,224 @@
+#ifndef FONT_HPP
+#define FONT_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "letters.hpp"
+
+namespace glyphs::font {
+
+/** @brief Where one glyph lives in its atlas, and how far it moves the pen */
+struct GlyphInfo {
+  uint16_t bit_offset; /* first bit of the glyph in the atlas */
+  uint8_t width;       /* pixels of ink, per row */
+  uint8_t advance;     /* pixels the pen moves after this glyph */
+};
+
+/** @brief Non-owning view of a font.  What the renderers take.
+ *
+ * Glyphs are 1bpp and packed back to back: each glyph is height rows of width
+ * bits, row after row, with no padding.  Bit 0 of a row is the leftmost pixel,
+ * same as LetterType.  Characters outside [first, last] draw as the '?' glyph.
+ */
+struct Font {
+  uint8_t height;
+  char first;
+  char last;
+  const GlyphInfo *glyphs;
+  const uint8_t *atlas;
+};
+
+/** @brief Storage for a font, sized at compile time. */
+template <size_t GLYPHS, size_t ATLAS_BYTES> struct Atlas {
+  uint8_t height;
+  char first;
+  std::array<GlyphInfo, GLYPHS> glyphs;
+  std::array<uint8_t, ATLAS_BYTES> atlas;
+
+  [[nodiscard]] constexpr Font view() const noexcept {
+    return {.height = height,
+            .first = first,
+            .last = static_cast<char>(first + GLYPHS - 1),
+            .glyphs = std::data(glyphs),
+            .atlas = std::data(atlas)};
+  }
+};
+
+[[nodiscard]] constexpr const GlyphInfo &lookup(const Font &font,
+                                                char c) noexcept {
+  if (c < font.first || c > font.last) {
+    c = '?' < font.first || '?' > font.last ? font.first : '?';
+  }
+  return font.glyphs[c - font.first];
+}
+
+/** @brief One row of a glyph, bit 0 is the leftmost pixel */
+[[nodiscard]] constexpr uint32_t row_bits(const Font &font,
+                                          const GlyphInfo &glyph,
+                                          uint32_t row) noexcept {
+  uint32_t bit{glyph.bit_offset + row * glyph.width};
+  uint32_t rv{0};
+  for (uint32_t xx = 0; xx < glyph.width; ++xx, ++bit) {
+    rv |= static_cast<uint32_t>((font.atlas[bit >> 3] >> (bit & 7)) & 0b1)
+          << xx;
+  }
+  return rv;
+}
+
+/** @brief Pixels covered by a line of text, before scaling */
+[[nodiscard]] constexpr uint32_t text_width(const Font &font, const char *str,
+                                            size_t len) noexcept {
+  uint32_t rv{0};
+  for (size_t idx = 0; idx < len; ++idx) {
+    rv += lookup(font, str[idx]).advance;
+  }
+  return rv;
+}
+
+namespace details {
+
+inline constexpr char FIRST_PRINTABLE{' '};
+inline constexpr size_t PRINTABLE_COUNT{'~' - ' ' + 1};
+
+/** @brief Columns of a LetterType with any ink in them */
+[[nodiscard]] constexpr uint8_t ink_columns(const LetterType &letter) noexcept {
+  uint8_t rv{0};
+  for (size_t row = 0; row < LetterType::height_pixels; ++row) {
+    rv |= letter[row];
+  }
+  return rv;
+}
+
+template <size_t GLYPHS, size_t ATLAS_BYTES>
+constexpr void pack(Atlas<GLYPHS, ATLAS_BYTES> &font, size_t idx,
+                    const LetterType &letter, uint32_t first_column,
+                    uint32_t width, uint32_t advance, uint32_t &bit) noexcept {
+  font.glyphs[idx] = {.bit_offset = static_cast<uint16_t>(bit),
+                      .width = static_cast<uint8_t>(width),
+                      .advance = static_cast<uint8_t>(advance)};
+  for (size_t row = 0; row < LetterType::height_pixels; ++row) {
+    for (uint32_t xx = 0; xx < width; ++xx, ++bit) {
+      const auto set{(letter[row] >> (first_column + xx)) & 0b1};
+      font.atlas[bit >> 3] |= static_cast<uint8_t>(set << (bit & 7));
+    }
+  }
+}
+
+/** @brief Bits needed for the proportional atlas */
+[[nodiscard]] constexpr size_t proportional_bits() noexcept {
+  size_t rv{0};
+  for (size_t idx = 0; idx < PRINTABLE_COUNT; ++idx) {
+    const auto ink{ink_columns(
+        decode_ascii(static_cast<char>(FIRST_PRINTABLE + idx)))};
+    rv += LetterType::height_pixels *
+          (ink == 0 ? 0 : std::bit_width(ink) - std::countr_zero(ink));
+  }
+  return rv;
+}
+
+} // namespace details
+
+/** @brief The console glyphs with their empty columns trimmed off.
+ *
+ * Advance is the ink width plus one pixel of spacing; space is three pixels.
+ */
+[[nodiscard]] constexpr auto make_proportional() noexcept {
+  constexpr size_t BYTES{(details::proportional_bits() + 7) / 8};
+  Atlas<details::PRINTABLE_COUNT, BYTES> rv{
+      .height = LetterType::height_pixels,
+      .first = details::FIRST_PRINTABLE,
+      .glyphs = {},
+      .atlas = {}};
+  uint32_t bit{0};
+  for (size_t idx = 0; idx < details::PRINTABLE_COUNT; ++idx) {
+    const auto &letter{
+        decode_ascii(static_cast<char>(details::FIRST_PRINTABLE + idx))};
+    const auto ink{details::ink_columns(letter)};
+    if (ink == 0) {
+      details::pack(rv, idx, letter, 0, 0, 3, bit);
+      continue;
+    }
+    const uint32_t first_column{static_cast<uint32_t>(std::countr_zero(ink))};
+    const uint32_t width{static_cast<uint32_t>(std::bit_width(ink)) -
+                         first_column};
+    details::pack(rv, idx, letter, first_column, width, width + 1, bit);
+  }
+  return rv;
+}
+
+/** @brief The console glyphs on a 7 pixel pitch, instead of 8.
+ *
+ * None of them use the rightmost two columns of their cell, so one can go.
+ * Same look as the console, 34 characters across 240 pixels instead of 30.
+ */
+[[nodiscard]] constexpr auto make_condensed() noexcept {
+  constexpr uint32_t WIDTH{6};
+  Atlas<details::PRINTABLE_COUNT,
+        details::PRINTABLE_COUNT * WIDTH * LetterType::height_pixels / 8>
+      rv{.height = LetterType::height_pixels,
+         .first = details::FIRST_PRINTABLE,
+         .glyphs = {},
+         .atlas = {}};
+  uint32_t bit{0};
+  for (size_t idx = 0; idx < details::PRINTABLE_COUNT; ++idx) {
+    const auto &letter{
+        decode_ascii(static_cast<char>(details::FIRST_PRINTABLE + idx))};
+    details::pack(rv, idx, letter, 0, WIDTH, WIDTH + 1, bit);
+  }
+  return rv;
+}
+
+inline constexpr auto g_proportional{make_proportional()};
+inline constexpr auto g_condensed{make_condensed()};
+
+[[nodiscard]] constexpr Font proportional() noexcept {
+  return g_proportional.view();
+}
+[[nodiscard]] constexpr Font condensed() noexcept { return g_condensed.view(); }
+
+namespace constexpr_testing {
+
+static constexpr bool run_font_test() {
+  bool status{true};
+
+  /* nothing in the console font may be cut off by the condensed pitch */
+  for (char c = ' '; c <= '~'; ++c) {
+    status &= (details::ink_columns(decode_ascii(c)) & 0b1100'0000) == 0;
+  }
+
+  /* every glyph unpacks back to the console glyph it came from */
+  for (const auto font : {proportional(), condensed()}) {
+    for (char c = ' '; c <= '~'; ++c) {
+      const auto &letter{decode_ascii(c)};
+      const auto &glyph{lookup(font, c)};
+      const auto ink{details::ink_columns(letter)};
+      const auto shift{glyph.width == 6 || ink == 0 ? 0
+                                                    : std::countr_zero(ink)};
+      for (uint32_t row = 0; row < font.height; ++row) {
+        status &= row_bits(font, glyph, row) ==
+                  static_cast<uint32_t>(letter[row] >> shift);
+      }
+    }
+  }
+
+  /* layout */
+  {
+    const auto font{proportional()};
+    status &= lookup(font, ' ').advance == 3;
+    status &= lookup(font, 'i').width == 2;
+    status &= text_width(font, "ii", 2) == 6;
+    status &= &lookup(font, '\n') == &lookup(font, '?');
+    status &= text_width(condensed(), "Level", 5) == 35;
+  }
+
+  return status;
+}
+static_assert(run_font_test());
+
+} // namespace constexpr_testing
+} // namespace glyphs::font
+
+#endif
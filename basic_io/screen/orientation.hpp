@@ -0,0 +1,42 @@
+#if !defined(SCREEN_ORIENTATION_HPP)
+#define SCREEN_ORIENTATION_HPP
+
+#include "screen_def.h"
+
+namespace screen::orientation {
+
+/** @return True for the quarter turns, which swap rows and columns. */
+[[nodiscard]] constexpr bool swaps_axes(Orientation orientation) noexcept {
+  return orientation == Orientation::LANDSCAPE ||
+         orientation == Orientation::LANDSCAPE_FLIPPED;
+}
+
+/** @return What a screen of upright dimensions measures, turned. */
+[[nodiscard]] constexpr Dimensions turned(Dimensions upright,
+                                          Orientation orientation) noexcept {
+  if (swaps_axes(orientation)) {
+    return {.width = upright.height, .height = upright.width};
+  }
+  return upright;
+}
+
+/** @brief What set_orientation() decides.
+ *
+ *  Out of console mode any orientation goes, and the drawing that can't
+ * follow the new row length refuses to draw instead.  In console mode the
+ * text has nowhere else to go, so only orientations the console's buffer is
+ * laid out for are taken.
+ *
+ * @tparam ConsoleBuffer The TileBuffer the console draws through.
+ * @param upright The panel, in portrait.
+ */
+template <class ConsoleBuffer>
+[[nodiscard]] constexpr bool accepts(Orientation orientation, bool console_mode,
+                                     Dimensions upright) noexcept {
+  const auto dims{turned(upright, orientation)};
+  return !console_mode || ConsoleBuffer::laid_out_for(dims.width, dims.height);
+}
+
+} // namespace screen::orientation
+
+#endif
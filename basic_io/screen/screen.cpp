@@ -1,6 +1,7 @@
 #include "screen.hpp"
 #include "screen_def.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -18,7 +19,10 @@
 #endif
 
 #include "TileBuffer.hpp"
+#include "glyphs/font.hpp"
 #include "glyphs/letters.hpp"
+#include "orientation.hpp"
+#include "sprite_cache.hpp"
 
 namespace {
 
@@ -36,6 +40,7 @@ inline constexpr size_t BUFLEN{DISPLAY_WIDTH * DISPLAY_HEIGHT *
                                CONFIGURED_MAX_BPP / 8};
 
 bool g_video_is_initd{false};
+bool g_console_mode{false}; /* set_console_mode() and nothing since */
 
 template <class T, class U>
 constexpr void init_to_all_val(T &buf, const U &val) {
@@ -69,7 +74,10 @@ namespace screen {
 
 uint32_t get_buf_len() { return BUFLEN; }
 
-void set_format(Format fmt) noexcept { screen_impl::set_format(fmt); }
+void set_format(Format fmt) noexcept {
+  g_console_mode = false;
+  screen_impl::set_format(fmt);
+}
 
 Format get_format() noexcept { return screen_impl::get_format(); }
 
@@ -83,23 +91,37 @@ void set_virtual_screen_size([[maybe_unused]] Position new_topleft,
 }
 
 [[nodiscard]] Dimensions get_physical_screen_size() noexcept {
-  return {.width = screen_impl::PHYSICAL_WIDTH_PIXELS,
-          .height = screen_impl::PHYSICAL_HEIGHT_PIXELS};
+  return screen_impl::get_physical_screen_size();
 }
 
+bool set_orientation(Orientation orientation, bool mirrored) noexcept {
+  /* the console draws with the portrait row length built in */
+  if (!orientation::accepts<decltype(tile_buf_1bpp)>(
+          orientation, g_console_mode,
+          {.width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT})) {
+    return false;
+  }
+  screen_impl::set_orientation(orientation, mirrored);
+  return true;
+}
+Orientation get_orientation() noexcept {
+  return screen_impl::get_orientation();
+}
+bool get_mirrored() noexcept { return screen_impl::get_mirrored(); }
+
 uint8_t *get_video_buffer() noexcept { return std::data(frame_buffer); }
 
 bool init(Position virtual_topleft, Dimensions virtual_size,
           Format format) noexcept {
+  g_console_mode = false;
   /* check if we are already init'd */
   if (!g_video_is_initd) {
     g_video_is_initd = true;
     return screen_impl::init(std::data(frame_buffer), virtual_topleft,
                              virtual_size, format);
   }
-  set_format(format);
-  set_virtual_screen_size(virtual_topleft, virtual_size);
-  return true;
+  /* one restart of the stream, with the new depth and size already agreed */
+  return screen_impl::set_mode(format, virtual_size);
 }
 
 void init_clut(const Clut *entries, uint32_t length) noexcept {
@@ -110,9 +132,40 @@ void set_video_buffer(const uint8_t *buffer) noexcept {
   screen_impl::set_video_buffer(buffer);
 }
 
+ModeSwitchStats get_mode_switch_stats() noexcept {
+  return screen_impl::get_mode_switch_stats();
+}
+
+void set_refresh_mode(RefreshMode mode) noexcept {
+  screen_impl::set_refresh_mode(mode);
+}
+RefreshMode get_refresh_mode() noexcept {
+  return screen_impl::get_refresh_mode();
+}
+void refresh(const Region *regions, uint32_t count) noexcept {
+  screen_impl::refresh(regions, count);
+}
+void present() noexcept { screen_impl::present(); }
+
 [[nodiscard]] bool get_touch_report(TouchReport &out) {
   return screen_impl::get_touch_report(out);
 }
+[[nodiscard]] uint32_t get_touch_reports(TouchReport *out, uint32_t max_count) {
+  return screen_impl::get_touch_reports(out, max_count);
+}
+[[nodiscard]] uint32_t get_touch_reports_dropped() noexcept {
+  return screen_impl::get_touch_reports_dropped();
+}
+void set_touch_calibration(const TouchCalibration &cal) noexcept {
+  screen_impl::set_touch_calibration(cal);
+}
+[[nodiscard]] TouchCalibration get_touch_calibration() noexcept {
+  return screen_impl::get_touch_calibration();
+}
+void set_touch_raw(bool raw) noexcept { screen_impl::set_touch_raw(raw); }
+[[nodiscard]] bool save_touch_calibration() noexcept {
+  return screen_impl::save_touch_calibration();
+}
 
 /* =========================================================== */
 /*                  Video-Only Mode                            */
@@ -122,6 +175,7 @@ void clear_screen() {
   switch (screen::get_format()) {
   case screen::Format::GREY1:
   case screen::Format::GREY2:
+  case screen::Format::RGB565_LUT2:
   case screen::Format::GREY4:
   case screen::Format::RGB565:
   case screen::Format::RGB565_LUT4:
@@ -135,25 +189,45 @@ void draw_tile(uint32_t xpos, uint32_t ypos, Tile tile) {
     return;
   }
 
+  /* sub-byte formats all share the full-resolution frame, at whatever row
+   * length the screen has now */
+  const auto dims{get_virtual_screen_size()};
+  if (sprite_cache::blit(std::data(frame_buffer), dims.width, xpos, ypos,
+                         tile)) {
+    return;
+  }
+
+  /* the tile buffers have the portrait row length built in; turned, or
+   * resized away from it, they would shear every tile, so draw nothing */
+  auto &&draw_if_laid_out{[&](auto &tilebuf) {
+    if (tilebuf.laid_out_for(dims.width, dims.height)) {
+      draw(tilebuf, tile, xpos, ypos);
+    }
+  }};
   switch (tile.format) {
   case screen::Format::GREY1:
-    draw(tile_buf_1bpp, tile, xpos, ypos);
+    draw_if_laid_out(tile_buf_1bpp);
     break;
   case screen::Format::GREY2:
-    draw(tile_buf_2bpp, tile, xpos, ypos);
+  case screen::Format::RGB565_LUT2:
+    draw_if_laid_out(tile_buf_2bpp);
     break;
   case screen::Format::GREY4:
   case screen::Format::RGB565_LUT4:
-    draw(tile_buf_4bpp, tile, xpos, ypos);
+    draw_if_laid_out(tile_buf_4bpp);
     break;
   case screen::Format::RGB565_LUT8:
-    draw(tile_buf_8bpp, tile, xpos, ypos);
+    draw_if_laid_out(tile_buf_8bpp);
     break;
   case screen::Format::RGB565:
-    draw(tile_buf_16bpp, tile, xpos, ypos);
+    draw_if_laid_out(tile_buf_16bpp);
     break;
   }
 }
+bool cache_tile(Tile tile) noexcept { return sprite_cache::add(tile); }
+
+void clear_tile_cache() noexcept { sprite_cache::clear(); }
+
 void draw_tile_with_replacement(uint32_t xpos, uint32_t ypos, Tile tile,
                                 uint32_t pattern, uint32_t replacement) {}
 
@@ -173,6 +247,7 @@ compute_column_byte_offset(const screen::Format fmt,
   case screen::Format::GREY1:
     return pixel_offset >> 3;
   case screen::Format::GREY2:
+  case screen::Format::RGB565_LUT2:
     return pixel_offset >> 2;
   case screen::Format::GREY4:
   case screen::Format::RGB565_LUT4:
@@ -236,6 +311,7 @@ void fillrows(uint32_t value, uint32_t row_start, uint32_t row_finish,
                  (value & 0b1) << 6 | (value & 0b1) << 7;
       break;
     case screen::Format::GREY2:
+    case screen::Format::RGB565_LUT2:
       expanded = (value & 0b11) | (value & 0b11) << 2 | (value & 0b11) << 4 |
                  (value & 0b11) << 6;
       break;
@@ -256,6 +332,128 @@ void fillrows(uint32_t value, uint32_t row_start, uint32_t row_finish,
   }
 }
 
+void fillspan(uint32_t value, uint32_t row, uint32_t column_start,
+              uint32_t column_finish) {
+  const auto dims{get_virtual_screen_size()};
+  column_finish = std::min(column_finish, dims.width);
+  if (row >= dims.height || column_start >= column_finish) {
+    return;
+  }
+
+  const auto fmt{screen::get_format()};
+  auto *p_row{get_start_of_row(std::data(frame_buffer), fmt, row, dims)};
+
+  if (fmt == screen::Format::RGB565) {
+    for (uint32_t col = column_start; col < column_finish; ++col) {
+      p_row[col << 1] = value & 0xff;
+      p_row[(col << 1) + 1] = (value >> 8) & 0xff;
+    }
+    return;
+  }
+
+  /* partial bytes at either end get masked in, the middle is a memset */
+  const uint32_t bpp{static_cast<uint32_t>(bitsizeof(fmt))};
+  const uint8_t expanded{expand(value & ((1U << bpp) - 1), fmt)};
+  const uint32_t bit_start{column_start * bpp};
+  const uint32_t bit_finish{column_finish * bpp};
+  uint32_t byte_start{bit_start >> 3};
+  const uint32_t byte_finish{bit_finish >> 3};
+  const uint8_t head_mask{static_cast<uint8_t>(0xFF << (bit_start & 7))};
+  const uint8_t tail_mask{static_cast<uint8_t>((1U << (bit_finish & 7)) - 1)};
+
+  if (byte_start == byte_finish) {
+    const uint8_t mask{static_cast<uint8_t>(head_mask & tail_mask)};
+    p_row[byte_start] = (p_row[byte_start] & ~mask) | (expanded & mask);
+    return;
+  }
+  if ((bit_start & 7) != 0) {
+    p_row[byte_start] =
+        (p_row[byte_start] & ~head_mask) | (expanded & head_mask);
+    ++byte_start;
+  }
+  memset(std::next(p_row, byte_start), expanded, byte_finish - byte_start);
+  if (tail_mask != 0) {
+    p_row[byte_finish] =
+        (p_row[byte_finish] & ~tail_mask) | (expanded & tail_mask);
+  }
+}
+
+void fillcolumn(uint32_t value, uint32_t column, uint32_t row_start,
+                uint32_t row_finish) {
+  const auto dims{get_virtual_screen_size()};
+  row_finish = std::min(row_finish, dims.height);
+  if (column >= dims.width || row_start >= row_finish) {
+    return;
+  }
+
+  const auto fmt{screen::get_format()};
+  const auto pitch{compute_column_byte_offset(fmt, dims.width)};
+  auto *p_pix{std::next(get_start_of_row(std::data(frame_buffer), fmt,
+                                         row_start, dims),
+                        compute_column_byte_offset(fmt, column))};
+  const auto *const p_end{std::next(p_pix, (row_finish - row_start) * pitch)};
+
+  if (fmt == screen::Format::RGB565) {
+    for (; p_pix != p_end; std::advance(p_pix, pitch)) {
+      p_pix[0] = value & 0xff;
+      p_pix[1] = (value >> 8) & 0xff;
+    }
+    return;
+  }
+  if (fmt == screen::Format::RGB565_LUT8) {
+    for (; p_pix != p_end; std::advance(p_pix, pitch)) {
+      *p_pix = static_cast<uint8_t>(value);
+    }
+    return;
+  }
+
+  const uint32_t bpp{static_cast<uint32_t>(bitsizeof(fmt))};
+  const uint32_t shift{subbyte_index(column, fmt) * bpp};
+  const uint8_t keep{static_cast<uint8_t>(~(((1U << bpp) - 1) << shift))};
+  const uint8_t setval{
+      static_cast<uint8_t>((value & ((1U << bpp) - 1)) << shift)};
+  for (; p_pix != p_end; std::advance(p_pix, pitch)) {
+    *p_pix = (*p_pix & keep) | setval;
+  }
+}
+
+void copycolumn(uint32_t dst, uint32_t src, uint32_t row_start,
+                uint32_t row_finish) {
+  const auto dims{get_virtual_screen_size()};
+  row_finish = std::min(row_finish, dims.height);
+  if (dst >= dims.width || src >= dims.width || row_start >= row_finish) {
+    return;
+  }
+
+  const auto fmt{screen::get_format()};
+  const auto pitch{compute_column_byte_offset(fmt, dims.width)};
+  auto *p_row{
+      get_start_of_row(std::data(frame_buffer), fmt, row_start, dims)};
+  auto *p_dst{std::next(p_row, compute_column_byte_offset(fmt, dst))};
+  const auto *p_src{std::next(p_row, compute_column_byte_offset(fmt, src))};
+  const auto *const p_end{std::next(p_dst, (row_finish - row_start) * pitch)};
+
+  if (fmt == screen::Format::RGB565 || fmt == screen::Format::RGB565_LUT8) {
+    const auto bytes{bitsizeof(fmt) / 8};
+    for (; p_dst != p_end;
+         std::advance(p_dst, pitch), std::advance(p_src, pitch)) {
+      memcpy(p_dst, p_src, bytes);
+    }
+    return;
+  }
+
+  const uint32_t bpp{static_cast<uint32_t>(bitsizeof(fmt))};
+  const uint32_t mask{(1U << bpp) - 1};
+  const uint32_t src_shift{subbyte_index(src, fmt) * bpp};
+  const uint32_t dst_shift{subbyte_index(dst, fmt) * bpp};
+  const uint8_t keep{static_cast<uint8_t>(~(mask << dst_shift))};
+  for (; p_dst != p_end;
+       std::advance(p_dst, pitch), std::advance(p_src, pitch)) {
+    const uint32_t pix{(*p_src >> src_shift) & mask};
+    *p_dst = static_cast<uint8_t>((*p_dst & keep) | (pix << dst_shift));
+  }
+}
+
 void copyrow(const uint32_t dst, const uint32_t src, uint32_t column_start,
              uint32_t column_finish) {
 
@@ -281,6 +479,37 @@ void copyrow(const uint32_t dst, const uint32_t src, uint32_t column_start,
   memcpy(std::next(p_dst, start), std::next(p_src, start), finish - start);
 }
 
+void scroll(int32_t dx, int32_t dy, uint32_t fill_value) {
+  const auto dims{get_virtual_screen_size()};
+  scroll(dx, dy, fill_value, {.row = 0, .column = 0}, dims);
+}
+
+void scroll(int32_t dx, int32_t dy, uint32_t fill_value, Position topleft,
+            Dimensions size) {
+  const gfx::Rect region{
+      .topleft = {.x = topleft.column, .y = topleft.row},
+      .size = {.width = size.width, .height = size.height}};
+  switch (screen::get_format()) {
+  case screen::Format::GREY1:
+    scroll(tile_buf_1bpp, dx, dy, fill_value, region);
+    break;
+  case screen::Format::GREY2:
+  case screen::Format::RGB565_LUT2:
+    scroll(tile_buf_2bpp, dx, dy, fill_value, region);
+    break;
+  case screen::Format::GREY4:
+  case screen::Format::RGB565_LUT4:
+    scroll(tile_buf_4bpp, dx, dy, fill_value, region);
+    break;
+  case screen::Format::RGB565_LUT8:
+    scroll(tile_buf_8bpp, dx, dy, fill_value, region);
+    break;
+  case screen::Format::RGB565:
+    scroll(tile_buf_16bpp, dx, dy, fill_value, region);
+    break;
+  }
+}
+
 void melt(uint32_t replacement_value) {
   /* this is an interesting one
    * concept is:
@@ -390,6 +619,88 @@ uint32_t peek(uint32_t xpos, uint32_t ypos) noexcept {
   return (pbuf[byteidx] & clearmask) >> shift;
 }
 
+uint32_t draw_text(uint32_t xpos, uint32_t ypos, const char *str, size_t len,
+                   const glyphs::font::Font &font, uint32_t foreground,
+                   uint32_t background, uint32_t scale) {
+  const auto fmt{get_format()};
+  const auto dims{get_virtual_screen_size()};
+  if (scale == 0 || xpos >= dims.width || ypos >= dims.height) {
+    return 0;
+  }
+
+  const uint32_t bpp{static_cast<uint32_t>(bitsizeof(fmt))};
+  const uint32_t width{std::min(
+      glyphs::font::text_width(font, str, len) * scale, dims.width - xpos)};
+  if (width == 0) {
+    return 0;
+  }
+  const uint32_t pitch{compute_column_byte_offset(fmt, dims.width)};
+  const uint32_t lead_bits{(xpos * bpp) & 7};
+  const uint32_t end_bits{lead_bits + width * bpp};
+  const uint32_t row_bytes{(end_bits + 7) / 8};
+  /* the widest row of any format in either orientation, plus a byte for a
+   * sub-byte start */
+  static std::array<uint8_t,
+                    std::max(DISPLAY_WIDTH, DISPLAY_HEIGHT) * COLORBPP / 8 + 1>
+      row;
+  static_assert(MAX_SUPPORTED_BPP <= COLORBPP);
+  if (row_bytes > std::size(row)) {
+    return 0;
+  }
+  const uint8_t first_mask{static_cast<uint8_t>(0xFF << lead_bits)};
+  const uint8_t last_mask{static_cast<uint8_t>(0xFF >> (row_bytes * 8 - end_bits))};
+  const uint32_t value_mask{bpp == 16 ? 0xFFFFU : (1U << bpp) - 1};
+  foreground &= value_mask;
+  background &= value_mask;
+
+  auto *p_frame{std::data(frame_buffer) + compute_column_byte_offset(fmt, xpos)};
+  for (uint32_t src_row = 0; src_row < font.height; ++src_row) {
+    const uint32_t dst_row{ypos + src_row * scale};
+    if (dst_row >= dims.height) {
+      break;
+    }
+
+    /* lay out one pixel row of the whole line */
+    std::fill_n(std::begin(row), row_bytes, 0);
+    uint32_t bit{lead_bits};
+    uint32_t pixels{0};
+    for (size_t idx = 0; idx < len && pixels < width; ++idx) {
+      const auto &glyph{glyphs::font::lookup(font, str[idx])};
+      const auto ink{glyphs::font::row_bits(font, glyph, src_row)};
+      for (uint32_t xx = 0; xx < glyph.advance && pixels < width; ++xx) {
+        const uint32_t value{((ink >> xx) & 0b1) != 0 ? foreground
+                                                      : background};
+        for (uint32_t rep = 0; rep < scale && pixels < width; ++rep) {
+          if (bpp == 16) {
+            row[bit >> 3] = value & 0xFF;
+            row[(bit >> 3) + 1] = value >> 8;
+          } else {
+            row[bit >> 3] |= static_cast<uint8_t>(value << (bit & 7));
+          }
+          bit += bpp;
+          ++pixels;
+        }
+      }
+    }
+
+    /* and stamp it down scale times, keeping the pixels either side */
+    const uint32_t rows_out{std::min(scale, dims.height - dst_row)};
+    for (uint32_t rep = 0; rep < rows_out; ++rep) {
+      auto *p_dst{p_frame + (dst_row + rep) * pitch};
+      if (row_bytes == 1) {
+        const uint8_t mask{static_cast<uint8_t>(first_mask & last_mask)};
+        p_dst[0] = (p_dst[0] & ~mask) | (row[0] & mask);
+        continue;
+      }
+      p_dst[0] = (p_dst[0] & ~first_mask) | (row[0] & first_mask);
+      std::memcpy(p_dst + 1, std::data(row) + 1, row_bytes - 2);
+      p_dst[row_bytes - 1] = (p_dst[row_bytes - 1] & ~last_mask) |
+                             (row[row_bytes - 1] & last_mask);
+    }
+  }
+  return width;
+}
+
 /* =========================================================== */
 /*                   Text-Only Mode                            */
 /* =========================================================== */
@@ -406,23 +717,35 @@ static constexpr ConsoleConfig g_console_cfg{
     .char_height = glyphs::tile::height()};
 
 bool set_console_mode() noexcept {
+  /* text is laid out for the portrait row length; upside down is fine */
+  if (orientation::swaps_axes(get_orientation())) {
+    set_orientation(Orientation::PORTRAIT, get_mirrored());
+  }
   const bool status{init({.row = 0, .column = 0}, get_physical_screen_size(),
                          screen::Format::GREY1)};
   if (!status) {
     return status;
   }
+  /* whatever app was running is done with its sprites */
+  sprite_cache::clear();
   clear_console();
+  g_console_mode = true;
   return status;
 }
 
-void clear_console() {
-  /* set to all whitespace */
-  for (size_t yy = 0; yy < g_console_cfg.lines; ++yy) {
-    for (size_t xx = 0; xx < g_console_cfg.columns; ++xx) {
-      draw_letter(xx, yy, ' ');
-    }
-  }
-}
+/* a blank cell is all background pixels, so blanking is just a memset */
+static_assert(
+    [] {
+      for (const auto row : glyphs::decode_ascii(' ').m_data) {
+        if (row != 0) {
+          return false;
+        }
+      }
+      return true;
+    }(),
+    "console assumes the space glyph is all zero bits");
+
+void clear_console() { fill_screen(0x00); }
 
 screen::Dimensions get_console_width_and_height() noexcept {
   return {.width = g_console_cfg.columns, .height = g_console_cfg.lines};
@@ -435,6 +758,33 @@ void draw_letter(uint32_t column, uint32_t line, char c) {
   draw(tile_buf_1bpp, tile, xpos, ypos);
 }
 
+void draw_letters(uint32_t column, uint32_t line, const char *str,
+                  uint32_t count, bool inverted) {
+  /* in the console format, a glyph row is exactly one framebuffer byte */
+  static_assert(glyphs::tile::width() * TEXTBPP == 8);
+
+  if (column >= g_console_cfg.columns || line >= g_console_cfg.lines) {
+    return;
+  }
+  count = std::min<uint32_t>(count, g_console_cfg.columns - column);
+
+  std::array<const uint8_t *, g_console_cfg.columns> glyph_rows;
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    glyph_rows[idx] = std::data(glyphs::decode_ascii(str[idx]).m_data);
+  }
+
+  static constexpr uint32_t pitch{DISPLAY_WIDTH * TEXTBPP / 8};
+  const uint8_t flip{inverted ? uint8_t{0xFF} : uint8_t{0x00}};
+  auto *p_row{std::data(frame_buffer) +
+              line * g_console_cfg.char_height * pitch + column};
+  for (uint32_t yy = 0; yy < g_console_cfg.char_height; ++yy) {
+    for (uint32_t idx = 0; idx < count; ++idx) {
+      p_row[idx] = glyph_rows[idx][yy] ^ flip;
+    }
+    p_row += pitch;
+  }
+}
+
 void scroll_up(int lines) {
   /*
    *  | text .... |
@@ -447,21 +797,11 @@ void scroll_up(int lines) {
    *  | test .... |
    *  | best .... |
    *  |           |
+   *
+   * Whole pixel rows move, so this is a single memmove plus a memset of the
+   * uncovered lines. I also assume we are in 1bpp mode.  If not, we exit
+   * early.  A future feature.
    */
-
-  /* so, we start at the second line and copy it to the first
-   * then repeat until we get to the last line,
-   * which we just set to whitespace
-   * I also assume we are in 1bpp mode.  If not, we exit early.  A future
-   * feature.
-   */
-
-  auto *vbuf{std::data(frame_buffer)};
-  const auto dims{screen::get_console_width_and_height()};
-  const auto scroll_height_pix{glyphs::tile::height()};
-  const auto width_pix{screen::get_virtual_screen_size().width};
-  const auto pitch_pix{scroll_height_pix * width_pix};
-
   if (screen::get_format() != screen::Format::GREY1) {
     return;
   }
@@ -470,27 +810,11 @@ void scroll_up(int lines) {
     return;
   }
 
-  if (lines >= dims.height) {
+  if (lines >= g_console_cfg.lines) {
     clear_console();
+    return;
   }
 
-  int line = lines;
-  for (; line < dims.height; ++line) {
-    const auto idx{line * pitch_pix};
-    const auto prev_idx{idx - (pitch_pix * lines)};
-
-    /* TODO inner loop could be optimized?  The lines should be far enough
-     * apart that overlap isn't possible... Better measure! */
-    for (int xx = 0; xx < pitch_pix; xx += 8) {
-      vbuf[(prev_idx + xx) >> 3] = vbuf[(idx + xx) >> 3];
-    }
-  }
-
-  line = dims.height - lines;
-  for (; line < dims.height; ++line) {
-    for (int col = 0; col < width_pix; ++col) {
-      draw_letter(col, line, ' ');
-    }
-  }
+  scroll(tile_buf_1bpp, 0, -lines * g_console_cfg.char_height, 0);
 }
 } // namespace screen
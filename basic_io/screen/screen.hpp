@@ -6,6 +6,11 @@
 
 #include "TileDef.h"
 #include "screen_def.h"
+#include "touch_calibration.hpp"
+
+namespace glyphs::font {
+struct Font;
+}
 
 namespace screen {
 
@@ -28,24 +33,106 @@ void set_format(Format) noexcept;
 void set_virtual_screen_size(Position new_topleft,
                              Dimensions new_size) noexcept;
 
+/** @brief The panel's size, which way round depends on the orientation. */
 [[nodiscard]] Dimensions get_physical_screen_size() noexcept;
 
-/* =====================================================================================
+/** @brief Turn the picture on the glass, and optionally mirror it left to
+ * right.
+ *
+ *  The panel does the work, so it costs nothing per frame.  The landscape
+ * orientations swap the physical and virtual screen sizes, and with them the
+ * framebuffer's row length.  Drawing that follows the virtual screen size
+ * carries on as before; uncached tiles are skipped (see draw_tile()).  Console
+ * mode goes back to an upright orientation of its own accord.
+ *
+ * @return False, changing nothing, for a landscape orientation while in
+ * console mode; leave it with init() or set_format() first.
  */
+bool set_orientation(Orientation orientation, bool mirrored = false) noexcept;
+[[nodiscard]] Orientation get_orientation() noexcept;
+[[nodiscard]] bool get_mirrored() noexcept;
 
-/** @brief Get lateset touch report.
+/** @brief How long the last format or size change took.
  *
- *  Check the timestamp, as these may be stale.
+ *  Changes made while the display is on keep the panel up and only restart
+ * the pixel stream; power_up_us is what a full init costs, for comparison.
+ */
+[[nodiscard]] ModeSwitchStats get_mode_switch_stats() noexcept;
+
+/** @brief Choose between streaming the framebuffer to the panel nonstop, and
+ * only sending what refresh() is told about.
  *
- *  Once called, will emtpy the underlying ring buffer (it's only 1 element in
- * size).
+ *  On demand saves the SPI bus and DMA bandwidth for the frames where little
+ * changes.  Touch is sampled either way.
+ */
+void set_refresh_mode(RefreshMode mode) noexcept;
+[[nodiscard]] RefreshMode get_refresh_mode() noexcept;
+
+/** @brief Send these parts of the framebuffer to the panel.
  *
- * @param[out] out The latest report.  Don't use if return is false.
+ *  On demand mode only, a no-op otherwise.  Regions are widened to whole DMA
+ * words and clipped to the screen; if they add up to more than the whole
+ * screen, the whole screen is sent once instead.  Returns once the pixels are
+ * out, so drawing can resume straight away.
+ */
+void refresh(const Region *regions, uint32_t count) noexcept;
+
+/** @brief Send the whole framebuffer to the panel, once.
+ *
+ *  On demand mode only, a no-op otherwise.  For when too much has changed to
+ * bother listing regions.  Returns once the pixels are out.
+ */
+void present() noexcept;
+
+/* =====================================================================================
+ */
+
+/** @brief Get the oldest touch report not yet read.
+ *
+ *  Reports queue up between reads, every sample of a stroke in order.  Check
+ * the timestamp, as these may be stale.  x and y are pixels, see
+ * set_touch_calibration().
+ *
+ * @param[out] out The report.  Don't use if return is false.
  *
  * @return True if a new report is availble, false otherwise.
  */
 [[nodiscard]] bool get_touch_report(TouchReport &out);
 
+/** @brief Get every touch report gathered since the last read, up to
+ * max_count of them, oldest first.
+ *
+ * @return How many were written to out.
+ */
+[[nodiscard]] uint32_t get_touch_reports(TouchReport *out, uint32_t max_count);
+
+/** @brief Reports lost because the queue was full, since power up.  Wraps. */
+[[nodiscard]] uint32_t get_touch_reports_dropped() noexcept;
+
+/** @brief Map touch samples to pixels with cal, from now on.
+ *
+ *  cal is for the glass held upright (PORTRAIT, not mirrored).  Reports come
+ * out in get_physical_screen_size() coordinates for whichever orientation is
+ * set, clamped onto the panel.  Until set, a calibration saved with
+ * save_touch_calibration() is used, or failing that a built in one.
+ */
+void set_touch_calibration(const TouchCalibration &cal) noexcept;
+[[nodiscard]] TouchCalibration get_touch_calibration() noexcept;
+
+/** @brief Hand out the touch controller's own numbers instead of pixels, to
+ * calibrate from.  The calibration is kept for when this is turned off. */
+void set_touch_raw(bool raw) noexcept;
+
+/** @brief Keep the current calibration in flash, to be picked up at the next
+ * power up.
+ *
+ *  Stalls everything running from flash for a few tens of milliseconds.
+ * Core 1 must not be running anything.
+ *
+ * @return True if the calibration is in flash.
+ */
+[[nodiscard]] bool save_touch_calibration() noexcept;
+
 /* =====================================================================================
  */
 
@@ -60,15 +147,48 @@ void set_virtual_screen_size(Position new_topleft,
 void clear_screen();
 
 /** @brief Draw a tile to the video buffer
+ *
+ *  Cached tiles follow the screen's current row length.  The others are
+ * drawn with the full portrait screen's row length for the format, and are
+ * skipped while the virtual screen has any other, e.g. turned on its side.
  */
 void draw_tile(uint32_t xpos, uint32_t ypos, Tile tile);
 
+/** @brief Pre-shift a tile so drawing it at any column is an aligned copy.
+ *
+ *  Opt-in, for hot tiles in the sub-byte formats that get drawn at arbitrary
+ * x positions.  The cache has a fixed RAM budget and is emptied whenever the
+ * console comes back (i.e. when an app exits).  The tile's data must outlive
+ * its time in the cache.
+ *
+ * @return True if the tile is cached.  False is harmless; draws just take the
+ * regular path.
+ */
+bool cache_tile(Tile tile) noexcept;
+
+/** @brief Drop all tiles added with cache_tile. */
+void clear_tile_cache() noexcept;
+
 /** @brief Change a pixel in memory, format-aware */
 void poke(uint32_t xpos, uint32_t ypos, uint32_t value) noexcept;
 
 /** @brief Read a pixel in memory, format-aware */
 [[nodiscard]] uint32_t peek(uint32_t xpos, uint32_t ypos) noexcept;
 
+/** @brief Draw a line of text, in any font, at any pixel position.
+ *
+ *  Screen format aware.  The line is laid out and blitted one pixel row at a
+ * time, each glyph pixel becoming a scale x scale block.  Text running off the
+ * right or bottom edge is clipped.
+ *
+ * @param foreground Pixel value for glyph ink
+ * @param background Pixel value for everything else in the text's box
+ *
+ * @return Width of the text drawn, in pixels (after clipping)
+ */
+uint32_t draw_text(uint32_t xpos, uint32_t ypos, const char *str, size_t len,
+                   const glyphs::font::Font &font, uint32_t foreground,
+                   uint32_t background, uint32_t scale = 1);
 /** @brief fill the video buffer DIRECTLY
  *  does not take the screen's format into account, so be aware
  */
@@ -82,6 +202,27 @@ void fillrows(uint32_t value, uint32_t row_start, uint32_t row_finish,
               uint32_t column_start = std::numeric_limits<uint32_t>::min(),
               uint32_t column_finish = std::numeric_limits<uint32_t>::max());
 
+/** @brief Fill part of one row, to the exact pixel.
+ *  Screen format aware, and unlike fillrows the columns need no alignment.
+ *  Columns past the right edge are clipped, as is a row past the bottom.
+ *
+ * @param column_finish One past the last pixel to fill
+ */
+void fillspan(uint32_t value, uint32_t row, uint32_t column_start,
+              uint32_t column_finish);
+/** @brief Fill part of one column, i.e. a vertical line.
+ *  Screen format aware.  The byte address and mask are worked out once, then
+ * each row is just a step of the row pitch.  Clipped like fillspan.
+ *
+ * @param row_finish One past the last row to fill
+ */
+void fillcolumn(uint32_t value, uint32_t column, uint32_t row_start,
+                uint32_t row_finish);
+/** @brief copy part of one column of the frame to another column
+ *  Screen format aware, any columns.  Clipped like fillcolumn.
+ */
+void copycolumn(uint32_t dst, uint32_t src, uint32_t row_start,
+                uint32_t row_finish);
 /** @brief copy one line of the frame to another
  *    Does the right thing, regardless of display pixel format
  *    Option to specify a cropped extent
@@ -94,6 +235,22 @@ void copyrow(const uint32_t dst, const uint32_t src,
              uint32_t column_start = std::numeric_limits<uint32_t>::min(),
              uint32_t column_finish = std::numeric_limits<uint32_t>::max());
 
+/** @brief Move the contents of the screen by (dx, dy) pixels
+ *  Format-aware, and any pixel offset is allowed (sub-byte shifts included).
+ *  Pixels uncovered by the move are set to fill_value.
+ *
+ * @param dx Pixels to move right, negative to move left
+ * @param dy Pixels to move down, negative to move up
+ * @param fill_value Pixel value for the uncovered area. Is screen format aware.
+ */
+void scroll(int32_t dx, int32_t dy, uint32_t fill_value);
+
+/** @brief Same as above, but only the given rectangle is moved.
+ *  Pixels outside the rectangle are untouched.
+ */
+void scroll(int32_t dx, int32_t dy, uint32_t fill_value, Position topleft,
+            Dimensions size);
+
 /** @brief Melt the screen, DOOM style
  *
  *  This is a very simple implementation; when melting we only replace the
@@ -125,6 +282,16 @@ void clear_console();
  */
 void draw_letter(uint32_t column, uint32_t line, char c);
 
+/** @brief Draw a run of characters to the console, starting at a cell.
+ *
+ * Much quicker than draw_letter in a loop: the run is blitted one pixel row
+ * at a time.  Characters that would fall off the end of the line are dropped.
+ *
+ * @param inverted Draw in reverse video
+ */
+void draw_letters(uint32_t column, uint32_t line, const char *str,
+                  uint32_t count, bool inverted = false);
+
 /** @brief Scroll the text on the screen
  *
  * @param lines + if scroll upwards, - if scroll downwards
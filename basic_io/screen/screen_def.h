@@ -4,8 +4,6 @@
 #include <cstddef>
 #include <cstdint>
 
-/* #include "pico/time.h" */
-
 namespace screen {
 
 struct Position {
@@ -17,6 +15,36 @@ struct Dimensions {
   uint32_t height;
 };
 
+/** @brief A rectangle of the virtual screen, in pixels */
+struct Region {
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+};
+
+enum struct RefreshMode {
+  CONTINUOUS, /* the whole screen is resent, over and over */
+  ON_DEMAND   /* only when refresh() is called, and only what it is given */
+};
+
+/** @brief What changing modes costs, in microseconds */
+struct ModeSwitchStats {
+  uint32_t power_up_us; /* panel init and first frame, the old way to switch */
+  uint32_t blank_us;    /* of the first power up, clearing the whole panel */
+  uint32_t switch_us;   /* last format or size change with the panel kept up */
+  uint32_t switches;
+  uint32_t colmod_writes; /* switches that changed the panel's pixel format */
+};
+
+/** @brief Which way up the picture is on the glass, in quarter turns */
+enum struct Orientation : uint8_t {
+  PORTRAIT,          /* as the glass is, 240 wide */
+  LANDSCAPE,         /* a quarter turn, 320 wide */
+  PORTRAIT_FLIPPED,  /* upside down */
+  LANDSCAPE_FLIPPED, /* three quarter turns */
+};
+
 struct Clut {
   uint8_t r;
   uint8_t g;
@@ -27,16 +55,25 @@ struct TouchReport {
   int x;
   int y;
   bool pen_up; // indicate whether someone is touching the display or not
-  /* absolute_time_t timestamp; */
+  uint32_t timestamp_us; /* time_us_32() when sampled; subtract, don't compare */
 };
 
-enum struct Format { GREY1, GREY2, GREY4, RGB565_LUT4, RGB565_LUT8, RGB565 };
+enum struct Format {
+  GREY1,
+  GREY2,
+  GREY4,
+  RGB565_LUT2,
+  RGB565_LUT4,
+  RGB565_LUT8,
+  RGB565
+};
 
 [[nodiscard]] constexpr size_t bitsizeof(Format fmt) {
   switch (fmt) {
   case Format::GREY1:
     return 1U;
   case Format::GREY2:
+  case Format::RGB565_LUT2:
     return 2U;
   case Format::GREY4:
   case Format::RGB565_LUT4:
@@ -55,6 +92,7 @@ enum struct Format { GREY1, GREY2, GREY4, RGB565_LUT4, RGB565_LUT8, RGB565 };
   case Format::GREY1:
     return pixpos & 0b111;
   case Format::GREY2:
+  case Format::RGB565_LUT2:
     return pixpos & 0b11;
   case Format::GREY4:
   case Format::RGB565_LUT4:
@@ -74,6 +112,7 @@ enum struct Format { GREY1, GREY2, GREY4, RGB565_LUT4, RGB565_LUT8, RGB565 };
   case Format::GREY1:
     return position >> 3;
   case Format::GREY2:
+  case Format::RGB565_LUT2:
     return position >> 2;
   case Format::GREY4:
   case Format::RGB565_LUT4:
@@ -91,6 +130,7 @@ enum struct Format { GREY1, GREY2, GREY4, RGB565_LUT4, RGB565_LUT8, RGB565 };
   case Format::GREY1:
     return value ? 0xFF : 0x00;
   case Format::GREY2:
+  case Format::RGB565_LUT2:
     return value | (value << 2) | (value << 4) | (value << 6);
   case Format::GREY4:
   case Format::RGB565_LUT4:
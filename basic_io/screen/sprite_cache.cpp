@@ -0,0 +1,174 @@
+#include "sprite_cache.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "TileDef.h"
+#include "screen_def.h"
+
+namespace {
+
+/*
+ * Each cached tile owns one contiguous run of the arena.  For every sub-byte
+ * phase (8 for GREY1, 4 for GREY2, 2 for 4bpp formats) it holds:
+ *
+ *   mask row   : stride bytes, set bits cover the tile's pixels
+ *   data rows  : side_length rows of stride bytes, tile pixels pre-shifted
+ *                by phase pixels, zero outside the mask
+ *
+ * so drawing at any x is a plain byte loop:  dst = (dst & ~mask) | data
+ */
+struct Entry {
+  const uint8_t *data;
+  screen::Format format;
+  uint8_t side_length;
+  uint8_t stride;
+  uint16_t offset;
+};
+
+static_assert(SPRITE_CACHE_BYTES <= UINT16_MAX + 1,
+              "Entry::offset is only 16 bits wide");
+
+std::array<uint8_t, SPRITE_CACHE_BYTES> g_arena;
+std::array<Entry, SPRITE_CACHE_ENTRIES> g_entries;
+size_t g_entry_count{0};
+size_t g_arena_used{0};
+
+[[nodiscard]] constexpr bool is_cacheable(screen::Format fmt) noexcept {
+  return screen::bitsizeof(fmt) < 8;
+}
+
+[[nodiscard]] constexpr uint32_t phases(uint32_t bpp) noexcept {
+  return 8 / bpp;
+}
+
+/** @brief Bytes of one pre-shifted row, wide enough for the worst phase. */
+[[nodiscard]] constexpr uint32_t stride_for(uint32_t side_length,
+                                            uint32_t bpp) noexcept {
+  return ((side_length + phases(bpp) - 1) * bpp + 7) / 8;
+}
+
+/** @brief Bytes a given phase actually touches, so we never step past the
+ * tile's right edge. */
+[[nodiscard]] constexpr uint32_t span_for(uint32_t side_length, uint32_t bpp,
+                                          uint32_t phase) noexcept {
+  return ((side_length + phase) * bpp + 7) / 8;
+}
+
+[[nodiscard]] const Entry *find(const screen::Tile &tile) noexcept {
+  for (size_t idx = 0; idx < g_entry_count; ++idx) {
+    const auto &entry{g_entries[idx]};
+    if (entry.data == tile.data && entry.format == tile.format &&
+        entry.side_length == tile.side_length) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+[[nodiscard]] constexpr uint32_t get_pixel(const uint8_t *row, uint32_t pix,
+                                           uint32_t bpp) noexcept {
+  const uint32_t bit{pix * bpp};
+  return (row[bit >> 3] >> (bit & 7)) & ((1U << bpp) - 1);
+}
+
+/** @brief OR a pixel into a zeroed, packed row. */
+constexpr void or_pixel(uint8_t *row, uint32_t pix, uint32_t value,
+                        uint32_t bpp) noexcept {
+  const uint32_t bit{pix * bpp};
+  row[bit >> 3] |= value << (bit & 7);
+}
+
+} // namespace
+
+namespace screen::sprite_cache {
+
+bool add(Tile tile) noexcept {
+  if (!is_cacheable(tile.format) || tile.side_length == 0) {
+    return false;
+  }
+  if (find(tile) != nullptr) {
+    return true;
+  }
+  if (g_entry_count == std::size(g_entries)) {
+    return false;
+  }
+
+  const auto bpp{static_cast<uint32_t>(bitsizeof(tile.format))};
+  const uint32_t side{tile.side_length};
+  const uint32_t stride{stride_for(side, bpp)};
+  const uint32_t bytes{phases(bpp) * (side + 1) * stride};
+  if (g_arena_used + bytes > std::size(g_arena)) {
+    return false;
+  }
+
+  /* tile rows are byte aligned, per blit_Nbpp */
+  const uint32_t src_pitch{(side * bpp + 7) / 8};
+  const uint32_t all_ones{(1U << bpp) - 1};
+
+  auto *p_out{std::data(g_arena) + g_arena_used};
+  for (uint32_t phase = 0; phase < phases(bpp); ++phase) {
+    auto *p_mask{p_out};
+    for (uint32_t idx = 0; idx < (side + 1) * stride; ++idx) {
+      p_out[idx] = 0;
+    }
+    for (uint32_t xx = 0; xx < side; ++xx) {
+      or_pixel(p_mask, phase + xx, all_ones, bpp);
+    }
+    for (uint32_t yy = 0; yy < side; ++yy) {
+      auto *p_row{p_mask + (yy + 1) * stride};
+      const auto *p_src{tile.data + yy * src_pitch};
+      for (uint32_t xx = 0; xx < side; ++xx) {
+        or_pixel(p_row, phase + xx, get_pixel(p_src, xx, bpp), bpp);
+      }
+    }
+    p_out += (side + 1) * stride;
+  }
+
+  g_entries[g_entry_count++] = {.data = tile.data,
+                                .format = tile.format,
+                                .side_length = tile.side_length,
+                                .stride = static_cast<uint8_t>(stride),
+                                .offset = static_cast<uint16_t>(g_arena_used)};
+  g_arena_used += bytes;
+  return true;
+}
+
+void clear() noexcept {
+  g_entry_count = 0;
+  g_arena_used = 0;
+}
+
+bool blit(uint8_t *__restrict buffer, size_t width, size_t x, size_t y,
+          Tile tile) noexcept {
+  const auto *p_entry{find(tile)};
+  if (p_entry == nullptr) {
+    return false;
+  }
+
+  const auto bpp{static_cast<uint32_t>(bitsizeof(tile.format))};
+  const uint32_t side{p_entry->side_length};
+  const uint32_t stride{p_entry->stride};
+  const uint32_t phase{static_cast<uint32_t>(x % phases(bpp))};
+  const uint32_t span{span_for(side, bpp, phase)};
+
+  const auto *p_mask{std::data(g_arena) + p_entry->offset +
+                     phase * (side + 1) * stride};
+  const auto *p_src{p_mask + stride};
+  const size_t pitch{width * bpp / 8};
+  auto *p_dst{buffer + y * pitch + x * bpp / 8};
+
+  for (uint32_t yy = 0; yy < side; ++yy) {
+    for (uint32_t idx = 0; idx < span; ++idx) {
+      p_dst[idx] = (p_dst[idx] & ~p_mask[idx]) | p_src[idx];
+    }
+    p_src += stride;
+    p_dst += pitch;
+  }
+  return true;
+}
+
+size_t bytes_used() noexcept { return g_arena_used; }
+
+} // namespace screen::sprite_cache
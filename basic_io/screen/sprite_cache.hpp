@@ -0,0 +1,53 @@
+#if !defined(SPRITE_CACHE_HPP)
+#define SPRITE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TileDef.h"
+
+/* RAM set aside for pre-shifted tiles, in bytes. */
+#if !defined(SPRITE_CACHE_BYTES)
+#define SPRITE_CACHE_BYTES 4096
+#endif
+
+/* Maximum number of distinct tiles that can be cached at once. */
+#if !defined(SPRITE_CACHE_ENTRIES)
+#define SPRITE_CACHE_ENTRIES 16
+#endif
+
+namespace screen::sprite_cache {
+
+/** @brief Build pre-shifted copies of a tile, one per sub-byte phase.
+ *
+ * Only the sub-byte formats (GREY1, GREY2, GREY4, RGB565_LUT2, RGB565_LUT4)
+ * are cached.  Tiles are identified by their data pointer, so the pixels must
+ * not change while cached.
+ *
+ * @return True if the tile is cached (or already was), false if the format
+ * isn't cacheable or the RAM budget is spent.
+ */
+bool add(Tile tile) noexcept;
+
+/** @brief Drop every cached tile and reclaim the whole budget. */
+void clear() noexcept;
+
+/** @brief Draw a cached tile as aligned, masked byte copies.
+ *
+ * @param buffer Raw video buffer
+ * @param width width of video frame, in pixels
+ * @param x Column offset, in pixels, to blit in the tile
+ * @param y Row offset, in pixels, to blit in the tile
+ * @param tile The tile to blit
+ *
+ * @return False if the tile isn't in the cache; nothing is drawn.
+ */
+[[nodiscard]] bool blit(uint8_t *__restrict buffer, size_t width, size_t x,
+                        size_t y, Tile tile) noexcept;
+
+/** @return Bytes of the budget currently in use. */
+[[nodiscard]] size_t bytes_used() noexcept;
+
+} // namespace screen::sprite_cache
+
+#endif
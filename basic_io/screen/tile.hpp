@@ -48,6 +48,7 @@ copy_with_replacement(screen::Tile tile, std::array<uint8_t, N> &outbuf,
                                    pattern, replacement);
     break;
   case Format::GREY2:
+  case Format::RGB565_LUT2:
     details::copy_and_replace_2bpp(tile.data, tilelen, std::data(outbuf),
                                    pattern, replacement);
     break;
@@ -0,0 +1,243 @@
+#if !defined(SCREEN_TOUCH_CALIBRATION_HPP)
+#define SCREEN_TOUCH_CALIBRATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "screen_def.h"
+
+namespace screen {
+
+/** @brief Affine map from raw touch samples to pixels, in Q16.16.
+ *
+ *   x = (xx * raw_x + xy * raw_y + x0) / 65536, rounded
+ *   y = (yx * raw_x + yy * raw_y + y0) / 65536, rounded
+ *
+ *  The cross terms soak up a panel glued on a little crooked.  Everything is
+ * 32 bit integer, so it is fine to apply from the touch interrupt.
+ */
+struct TouchCalibration {
+  int32_t xx;
+  int32_t xy;
+  int32_t x0;
+  int32_t yx;
+  int32_t yy;
+  int32_t y0;
+};
+
+/** @brief What the flash holds, so a calibration survives a reboot */
+struct TouchCalibrationRecord {
+  uint32_t magic;
+  uint32_t version;
+  TouchCalibration cal;
+  uint32_t crc; /* of everything above */
+};
+
+namespace touch_calibration {
+
+/** @brief A target drawn at (x, y), and what the touch controller said
+ * when it was pressed. */
+struct Point {
+  int32_t raw_x;
+  int32_t raw_y;
+  int32_t x;
+  int32_t y;
+};
+
+/* the XPT2046 samples are 12 bits */
+inline constexpr int32_t RAW_MAX{4095};
+
+/* keeps every term of the map inside an int32 for raw samples up to RAW_MAX:
+ * at most two pixels per raw step, and 8192 pixels of offset */
+inline constexpr int32_t MAX_SCALE_Q16{1 << 17};
+inline constexpr int32_t MAX_OFFSET_Q16{1 << 29};
+
+inline constexpr uint32_t RECORD_MAGIC{0x54434131}; /* "TCA1" */
+inline constexpr uint32_t RECORD_VERSION{1};
+
+namespace details {
+[[nodiscard]] constexpr int64_t div_round(int64_t num, int64_t den) noexcept {
+  if (den < 0) {
+    num = -num;
+    den = -den;
+  }
+  return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+[[nodiscard]] constexpr int64_t abs64(int64_t val) noexcept {
+  return val < 0 ? -val : val;
+}
+} // namespace details
+
+/** @brief Solve for the map that takes three raw samples to their targets.
+ *
+ *  Cramer's rule on the two 3x3 systems, in 64 bit, then scaled to Q16.16.
+ * Only ever done outside of the interrupt.
+ *
+ * @param[out] out The map.  Untouched if the return is false.
+ *
+ * @return False if the samples are (nearly) in a line, so there is no map,
+ * or the map found is too steep to apply without overflowing.
+ */
+[[nodiscard]] constexpr bool fit(const Point (&pts)[3],
+                                 TouchCalibration &out) noexcept {
+  const int64_t x0{pts[0].raw_x}, x1{pts[1].raw_x}, x2{pts[2].raw_x};
+  const int64_t y0{pts[0].raw_y}, y1{pts[1].raw_y}, y2{pts[2].raw_y};
+
+  const int64_t det{(x0 - x2) * (y1 - y2) - (x1 - x2) * (y0 - y2)};
+  if (det == 0) {
+    return false;
+  }
+
+  /* the coefficients taking the raw samples to one screen axis, d */
+  auto &&solve{[&](int64_t d0, int64_t d1, int64_t d2, int32_t &a, int32_t &b,
+                   int32_t &c) {
+    const int64_t a_num{(d0 - d2) * (y1 - y2) - (d1 - d2) * (y0 - y2)};
+    const int64_t b_num{(x0 - x2) * (d1 - d2) - (d0 - d2) * (x1 - x2)};
+    const int64_t c_num{y0 * (x2 * d1 - x1 * d2) + y1 * (x0 * d2 - x2 * d0) +
+                        y2 * (x1 * d0 - x0 * d1)};
+    const int64_t a_q16{details::div_round(a_num * 65536, det)};
+    const int64_t b_q16{details::div_round(b_num * 65536, det)};
+    const int64_t c_q16{details::div_round(c_num * 65536, det)};
+    if (details::abs64(a_q16) > MAX_SCALE_Q16 ||
+        details::abs64(b_q16) > MAX_SCALE_Q16 ||
+        details::abs64(c_q16) > MAX_OFFSET_Q16) {
+      return false;
+    }
+    a = static_cast<int32_t>(a_q16);
+    b = static_cast<int32_t>(b_q16);
+    c = static_cast<int32_t>(c_q16);
+    return true;
+  }};
+
+  TouchCalibration cal{};
+  if (!solve(pts[0].x, pts[1].x, pts[2].x, cal.xx, cal.xy, cal.x0) ||
+      !solve(pts[0].y, pts[1].y, pts[2].y, cal.yx, cal.yy, cal.y0)) {
+    return false;
+  }
+  out = cal;
+  return true;
+}
+
+/** @brief Where a raw sample lands, clamped onto a screen of size limits.
+ *
+ *  Raw samples are taken to be within [0, RAW_MAX].
+ */
+[[nodiscard]] constexpr TouchReport map(const TouchCalibration &cal,
+                                        int32_t raw_x, int32_t raw_y,
+                                        Dimensions limits) noexcept {
+  auto &&axis{[](int32_t a, int32_t b, int32_t c, int32_t rx, int32_t ry,
+                 uint32_t size) {
+    const int32_t val{(a * rx + b * ry + c + (1 << 15)) >> 16};
+    const auto hi{static_cast<int32_t>(size) - 1};
+    return val < 0 ? 0 : (val > hi ? hi : val);
+  }};
+  return {.x = axis(cal.xx, cal.xy, cal.x0, raw_x, raw_y, limits.width),
+          .y = axis(cal.yx, cal.yy, cal.y0, raw_x, raw_y, limits.height),
+          .pen_up = false,
+          .timestamp_us = 0};
+}
+
+/** @brief A calibration made on the upright glass, for the panel turned
+ * and mirrored.
+ *
+ *  Follows the ST7789's MADCTL: the picture is mirrored within the turned
+ * frame, then its rows and columns are exchanged.  Swapping and mirroring are
+ * both affine, so this is exact.
+ *
+ * @param glass The panel's size held upright.
+ */
+[[nodiscard]] constexpr TouchCalibration
+reoriented(const TouchCalibration &cal, Dimensions glass, bool swap_xy,
+           bool mirror_x, bool mirror_y) noexcept {
+  TouchCalibration out{swap_xy ? TouchCalibration{.xx = cal.yx,
+                                                  .xy = cal.yy,
+                                                  .x0 = cal.y0,
+                                                  .yx = cal.xx,
+                                                  .yy = cal.xy,
+                                                  .y0 = cal.x0}
+                               : cal};
+  const auto cols{static_cast<int32_t>(swap_xy ? glass.height : glass.width)};
+  const auto rows{static_cast<int32_t>(swap_xy ? glass.width : glass.height)};
+  if (mirror_x) {
+    out.xx = -out.xx;
+    out.xy = -out.xy;
+    out.x0 = (cols - 1) * 65536 - out.x0;
+  }
+  if (mirror_y) {
+    out.yx = -out.yx;
+    out.yy = -out.yy;
+    out.y0 = (rows - 1) * 65536 - out.y0;
+  }
+  return out;
+}
+
+/** @brief CRC-32 (the zlib one), a bit at a time; only run when saving and
+ * loading. */
+[[nodiscard]] constexpr uint32_t crc32(const uint8_t *data,
+                                       size_t length) noexcept {
+  uint32_t crc{0xFFFFFFFF};
+  for (size_t idx = 0; idx < length; ++idx) {
+    crc ^= data[idx];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0U - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+namespace details {
+[[nodiscard]] inline uint32_t record_crc(const TouchCalibrationRecord &rec) {
+  static_assert(offsetof(TouchCalibrationRecord, crc) ==
+                sizeof(TouchCalibrationRecord) - sizeof(uint32_t));
+  return crc32(reinterpret_cast<const uint8_t *>(&rec),
+               offsetof(TouchCalibrationRecord, crc));
+}
+} // namespace details
+
+/** @brief Wrap a calibration up for storage */
+[[nodiscard]] inline TouchCalibrationRecord
+make_record(const TouchCalibration &cal) noexcept {
+  TouchCalibrationRecord rec{
+      .magic = RECORD_MAGIC, .version = RECORD_VERSION, .cal = cal, .crc = 0};
+  rec.crc = details::record_crc(rec);
+  return rec;
+}
+
+/** @brief Unwrap a stored calibration.
+ *
+ * @return False if rec isn't one (e.g. erased flash), or is damaged.
+ */
+[[nodiscard]] inline bool read_record(const TouchCalibrationRecord &rec,
+                                      TouchCalibration &out) noexcept {
+  if (rec.magic != RECORD_MAGIC || rec.version != RECORD_VERSION ||
+      rec.crc != details::record_crc(rec)) {
+    return false;
+  }
+  out = rec.cal;
+  return true;
+}
+
+namespace details {
+[[nodiscard]] constexpr TouchCalibration fit_or_identity(const Point (&pts)[3]) {
+  TouchCalibration cal{.xx = 65536, .xy = 0, .x0 = 0, .yx = 0, .yy = 65536,
+                       .y0 = 0};
+  (void)fit(pts, cal);
+  return cal;
+}
+} // namespace details
+
+/** @brief Used until the panel is calibrated.
+ *
+ *  Measured on the Waveshare 2.8" board: the controller's x runs from about
+ * 250 on the right edge of the upright glass to 3600 on the left, and y from
+ * about 350 at the bottom to 3850 at the top.
+ */
+inline constexpr TouchCalibration DEFAULT{details::fit_or_identity(
+    {{.raw_x = 250, .raw_y = 350, .x = 239, .y = 319},
+     {.raw_x = 3600, .raw_y = 350, .x = 0, .y = 319},
+     {.raw_x = 250, .raw_y = 3850, .x = 239, .y = 0}})};
+
+} // namespace touch_calibration
+} // namespace screen
+
+#endif
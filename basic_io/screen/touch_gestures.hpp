@@ -0,0 +1,173 @@
+#if !defined(SCREEN_TOUCH_GESTURES_HPP)
+#define SCREEN_TOUCH_GESTURES_HPP
+
+#include <cstdint>
+
+#include "screen_def.h"
+
+namespace screen::gestures {
+
+enum struct Kind : uint8_t {
+  NONE,
+  TAP,        /* down and up again quickly, without moving */
+  LONG_PRESS, /* held still; fires once, while still down */
+  DRAG_START, /* moved off the spot it went down on */
+  DRAG,       /* every sample while dragging */
+  DRAG_END,   /* let go after a drag that wasn't a swipe */
+  SWIPE,      /* a quick flick, instead of DRAG_END */
+};
+
+enum struct Direction : uint8_t { UP, DOWN, LEFT, RIGHT };
+
+struct Gesture {
+  Kind kind;
+  int x; /* where it is now; for TAP and SWIPE, where it started */
+  int y;
+  int dx; /* DRAG: since the last one; otherwise since going down */
+  int dy;
+  Direction direction; /* SWIPE only */
+  uint32_t held_us;    /* since going down */
+};
+
+struct Config {
+  uint32_t slop_px{8}; /* wander allowed before a press becomes a drag */
+  uint32_t tap_max_us{300 * 1000};
+  uint32_t long_press_us{600 * 1000};
+  uint32_t swipe_min_px{40}; /* along the main axis */
+  uint32_t swipe_max_us{400 * 1000};
+};
+
+/** @brief Turns the touch report stream into gestures, one report at a time.
+ *
+ *  Each report costs a few compares and no loops, so it is fine to run over
+ * everything that queued up since the last frame.  Long presses are noticed
+ * on the next sample, which the controller keeps sending while the pen is
+ * down.  Times are the reports' own, and wrap safely.
+ */
+class Recognizer final {
+public:
+  constexpr Recognizer() noexcept = default;
+  explicit constexpr Recognizer(Config cfg) noexcept : m_cfg{cfg} {}
+
+  [[nodiscard]] constexpr const Config &config() const noexcept {
+    return m_cfg;
+  }
+  constexpr void config(Config cfg) noexcept { m_cfg = cfg; }
+
+  /** @brief Forget any press in progress, e.g. after reports were lost. */
+  constexpr void reset() noexcept { m_state = State::IDLE; }
+
+  /** @return What the report completes, Kind::NONE for nothing yet. */
+  [[nodiscard]] constexpr Gesture feed(const TouchReport &report) noexcept {
+    if (m_state == State::IDLE) {
+      if (!report.pen_up) {
+        m_state = State::PRESSED;
+        m_start_x = m_last_x = report.x;
+        m_start_y = m_last_y = report.y;
+        m_start_us = report.timestamp_us;
+      }
+      return none();
+    }
+
+    const uint32_t held_us{report.timestamp_us - m_start_us};
+    if (report.pen_up) {
+      const State was{m_state};
+      m_state = State::IDLE;
+      return released(was, held_us);
+    }
+
+    const int dx{report.x - m_start_x};
+    const int dy{report.y - m_start_y};
+    const bool wandered{abs(dx) > static_cast<int>(m_cfg.slop_px) ||
+                        abs(dy) > static_cast<int>(m_cfg.slop_px)};
+    switch (m_state) {
+    case State::PRESSED:
+      if (!wandered && held_us >= m_cfg.long_press_us) {
+        m_state = State::HELD;
+        return make(Kind::LONG_PRESS, m_start_x, m_start_y, 0, 0, held_us);
+      }
+      [[fallthrough]];
+    case State::HELD:
+      if (wandered) {
+        m_state = State::DRAGGING;
+        m_last_x = report.x;
+        m_last_y = report.y;
+        return make(Kind::DRAG_START, report.x, report.y, dx, dy, held_us);
+      }
+      return none();
+    case State::DRAGGING: {
+      const Gesture drag{make(Kind::DRAG, report.x, report.y,
+                              report.x - m_last_x, report.y - m_last_y,
+                              held_us)};
+      m_last_x = report.x;
+      m_last_y = report.y;
+      return drag;
+    }
+    case State::IDLE:
+      break;
+    }
+    return none();
+  }
+
+private:
+  enum struct State : uint8_t { IDLE, PRESSED, HELD, DRAGGING };
+
+  [[nodiscard]] static constexpr int abs(int val) noexcept {
+    return val < 0 ? -val : val;
+  }
+  [[nodiscard]] static constexpr Gesture make(Kind kind, int x, int y, int dx,
+                                              int dy, uint32_t held_us,
+                                              Direction dir = Direction::UP) {
+    return {.kind = kind,
+            .x = x,
+            .y = y,
+            .dx = dx,
+            .dy = dy,
+            .direction = dir,
+            .held_us = held_us};
+  }
+  [[nodiscard]] static constexpr Gesture none() noexcept {
+    return make(Kind::NONE, 0, 0, 0, 0, 0);
+  }
+
+  /* pen up reports carry no position, so the last one seen stands in */
+  [[nodiscard]] constexpr Gesture released(State was,
+                                           uint32_t held_us) const noexcept {
+    const int dx{m_last_x - m_start_x};
+    const int dy{m_last_y - m_start_y};
+    switch (was) {
+    case State::PRESSED:
+      return held_us <= m_cfg.tap_max_us
+                 ? make(Kind::TAP, m_start_x, m_start_y, 0, 0, held_us)
+                 : none();
+    case State::DRAGGING: {
+      const bool across{abs(dx) >= abs(dy)};
+      const int along{across ? abs(dx) : abs(dy)};
+      if (held_us <= m_cfg.swipe_max_us &&
+          along >= static_cast<int>(m_cfg.swipe_min_px)) {
+        const Direction dir{across ? (dx < 0 ? Direction::LEFT
+                                             : Direction::RIGHT)
+                                   : (dy < 0 ? Direction::UP : Direction::DOWN)};
+        return make(Kind::SWIPE, m_start_x, m_start_y, dx, dy, held_us, dir);
+      }
+      return make(Kind::DRAG_END, m_last_x, m_last_y, dx, dy, held_us);
+    }
+    case State::HELD:
+    case State::IDLE:
+      break;
+    }
+    return none();
+  }
+
+  Config m_cfg{};
+  State m_state{State::IDLE};
+  int m_start_x{0};
+  int m_start_y{0};
+  int m_last_x{0};
+  int m_last_y{0};
+  uint32_t m_start_us{0};
+};
+
+} // namespace screen::gestures
+
+#endif
@@ -0,0 +1,69 @@
+#include "dispLcdCommands.h"
+
+void dispLcdWriteSeq(const DispLcdBus_t *bus, const uint16_t *seq,
+                     uint32_t len) {
+  uint32_t i;
+
+  for (i = 0; i < len; i++) {
+    if (seq[i] >> 15)
+      bus->writeCmd(bus->ctx, seq[i]);
+    else
+      bus->writeData(bus->ctx, seq[i]);
+  }
+}
+
+uint8_t dispLcdColmod(uint8_t depth) {
+  // the grey modes go out as RGB444, CLUT and native as RGB565
+  return (DISP_DEPTH_IS_CLUT(depth) || depth == DISP_DEPTH_RGB565)
+             ? ST7789_COLMOD_RGB565
+             : ST7789_COLMOD_RGB444;
+}
+
+void dispLcdWriteColmod(const DispLcdBus_t *bus, uint8_t depth) {
+  bus->writeCmd(bus->ctx, ST7789_COLMOD);
+  bus->writeData(bus->ctx, dispLcdColmod(depth));
+}
+
+void dispLcdWriteMadctl(const DispLcdBus_t *bus, uint8_t orientation) {
+  bus->writeCmd(bus->ctx, ST7789_MADCTL);
+  bus->writeData(bus->ctx, orientation);
+}
+
+void dispLcdWriteInit(const DispLcdBus_t *bus, uint8_t depth,
+                      uint8_t orientation) {
+  // high bit means command
+  static const uint16_t mInitSeq[] = {
+      0x80b2, 0x000c, 0x000c, 0x0000, 0x0033, 0x0033, 0x80b7, 0x0035, 0x80bb,
+      0x0028, 0x80c0, 0x003c, 0x80c2, 0x0001, 0x80c3, 0x000b, 0x80c4, 0x0020,
+      0x80c6, 0x000f, 0x80c7, 0x0002, 0x80d0, 0x00a4, 0x00a1, 0x80e0, 0x00d0,
+      0x0001, 0x0008, 0x000f, 0x0011, 0x002a, 0x0036, 0x0055, 0x0044, 0x003a,
+      0x000b, 0x0006, 0x0011, 0x0020, 0x80e1, 0x00d0, 0x0002, 0x0007, 0x000a,
+      0x000b, 0x0018, 0x0034, 0x0043, 0x004a, 0x002b, 0x001b, 0x001c, 0x0022,
+      0x001f, 0x8055, 0x0000,
+      0x8029, // display on
+  };
+
+  bus->writeCmd(bus->ctx, ST7789_SLPOUT);
+
+  // set data format
+  dispLcdWriteMadctl(bus, orientation);
+  dispLcdWriteColmod(bus, depth);
+
+  dispLcdWriteSeq(bus, mInitSeq, sizeof(mInitSeq) / sizeof(*mInitSeq));
+}
+
+void dispLcdWriteWindow(const DispLcdBus_t *bus,
+                        const DispRefreshPlan_t *plan) {
+  uint16_t seq[DISP_PLAN_WINDOW_SEQ_LEN];
+
+  dispLcdWriteSeq(bus, seq, dispPlanWindowSeq(plan, seq));
+}
+
+void dispLcdWriteBlank(const DispLcdBus_t *bus, DispDimensions_t phys) {
+  const DispRefreshPlan_t all = {.width = phys.width, .height = phys.height};
+  uint32_t i;
+
+  dispLcdWriteWindow(bus, &all);
+  for (i = 0; i < phys.width * phys.height * 2; i++)
+    bus->writeData(bus->ctx, 0);
+}
@@ -0,0 +1,64 @@
+#ifndef _DISP_LCD_COMMANDS_H_
+#define _DISP_LCD_COMMANDS_H_
+
+// The ST7789 commands the driver sends from the CPU, written to whatever bus
+// it is handed.  On the Pico that is the bit-banged SPI; on a host it can be a
+// recorder, or an emulated panel.  Pixels streamed by the PIO do not come
+// through here.
+
+#include <stdint.h>
+
+#include "dispRefreshPlan.h"
+#include "dispWaveshareLcd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ST7789 commands we use
+#define ST7789_SLPOUT (0x11)
+#define ST7789_DISPON (0x29)
+#define ST7789_CASET (0x2a)
+#define ST7789_RASET (0x2b)
+#define ST7789_RAMWR (0x2c)
+#define ST7789_MADCTL (0x36)
+#define ST7789_COLMOD (0x3a)
+
+// COLMOD values
+#define ST7789_COLMOD_RGB444 (0x03)
+#define ST7789_COLMOD_RGB565 (0x05)
+
+typedef struct {
+  void (*writeCmd)(void *ctx, uint8_t cmd);   // DnC low
+  void (*writeData)(void *ctx, uint8_t data); // DnC high
+  void *ctx;
+} DispLcdBus_t;
+
+// high bit means command
+void dispLcdWriteSeq(const DispLcdBus_t *bus, const uint16_t *seq,
+                     uint32_t len);
+
+// pixel format the panel wants for a driver depth
+uint8_t dispLcdColmod(uint8_t depth);
+
+// just the pixel format, for a depth change on a panel that is already up
+void dispLcdWriteColmod(const DispLcdBus_t *bus, uint8_t depth);
+
+// how the address counters map onto the glass, DISP_ORIENT_* bits
+void dispLcdWriteMadctl(const DispLcdBus_t *bus, uint8_t orientation);
+
+// wake the panel, set it up for depth and orientation and turn it on
+void dispLcdWriteInit(const DispLcdBus_t *bus, uint8_t depth,
+                      uint8_t orientation);
+
+// CASET, RASET, then RAMWR, after which pixels go out as data
+void dispLcdWriteWindow(const DispLcdBus_t *bus,
+                        const DispRefreshPlan_t *plan);
+
+// the whole panel black, two zero bytes a pixel whatever the format
+void dispLcdWriteBlank(const DispLcdBus_t *bus, DispDimensions_t phys);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
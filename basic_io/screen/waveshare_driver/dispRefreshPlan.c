@@ -0,0 +1,99 @@
+#include "dispRefreshPlan.h"
+
+uint32_t dispPlanXferBytes(uint8_t depth) {
+  return depth == DISP_DEPTH_RGB565 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+uint32_t dispPlanWireBytes(uint8_t depth, uint32_t pixels) {
+  if (!DISP_DEPTH_IS_CLUT(depth) && depth != DISP_DEPTH_RGB565)
+    return pixels * 12 / 8;
+  return pixels * 2;
+}
+
+bool dispPlanRefresh(const DispRect_t *rect, uint8_t depth,
+                     DispDimensions_t virt, DispDimensions_t phys,
+                     DispRefreshPlan_t *plan) {
+  const uint32_t bpp = DISP_DEPTH_BPP(depth),
+                 xferBytes = dispPlanXferBytes(depth),
+                 pitch = virt.width * bpp / 8;
+  uint32_t x0, y0, x1, y1;
+
+  if (!bpp || rect->x >= virt.width || rect->y >= virt.height ||
+      !rect->width || !rect->height)
+    return false;
+
+  x0 = rect->x;
+  y0 = rect->y;
+  x1 = rect->width > virt.width - x0 ? virt.width : x0 + rect->width;
+  y1 = rect->height > virt.height - y0 ? virt.height : y0 + rect->height;
+
+  if (pitch % xferBytes == 0) {
+    // each row starts on a transfer, so just widen to whole transfers
+    const uint32_t pixPerXfer = xferBytes * 8 / bpp;
+
+    x0 -= x0 % pixPerXfer;
+    x1 += (pixPerXfer - x1 % pixPerXfer) % pixPerXfer;
+  } else {
+    // full rows, from a row that starts on a transfer; every Nth row does
+    uint32_t rowStep = 1;
+
+    while ((rowStep * pitch) % xferBytes)
+      rowStep++;
+    x0 = 0;
+    x1 = virt.width;
+    y0 -= y0 % rowStep;
+    y1 += (rowStep - y1 % rowStep) % rowStep;
+    if (y1 > virt.height)
+      y1 = virt.height;
+  }
+
+  if (x0 == 0 && x1 == virt.width) {
+    // full rows are back to back in the framebuffer, so one run does it
+    plan->runs = 1;
+    plan->runStride = 0;
+    plan->runXfers = (y1 - y0) * pitch / xferBytes;
+  } else {
+    plan->runs = y1 - y0;
+    plan->runStride = pitch;
+    plan->runXfers = (x1 - x0) * bpp / 8 / xferBytes;
+  }
+
+  plan->panelCol = (phys.width - virt.width) / 2 + x0;
+  plan->panelRow = (phys.height - virt.height) / 2 + y0;
+  plan->width = x1 - x0;
+  plan->height = y1 - y0;
+  plan->fbOffset = y0 * pitch + x0 * bpp / 8;
+  plan->xferBytes = xferBytes;
+  plan->wireBytes = dispPlanWireBytes(depth, plan->width * plan->height);
+  return true;
+}
+
+uint32_t dispPlanWindowSeq(const DispRefreshPlan_t *plan, uint16_t *seq) {
+  const uint_fast16_t endCol = plan->panelCol + plan->width - 1,
+                      endRow = plan->panelRow + plan->height - 1;
+  uint32_t n = 0;
+
+  seq[n++] = 0x802a;
+  seq[n++] = plan->panelCol >> 8;
+  seq[n++] = plan->panelCol & 0xff;
+  seq[n++] = endCol >> 8;
+  seq[n++] = endCol & 0xff;
+
+  seq[n++] = 0x802b;
+  seq[n++] = plan->panelRow >> 8;
+  seq[n++] = plan->panelRow & 0xff;
+  seq[n++] = endRow >> 8;
+  seq[n++] = endRow & 0xff;
+
+  seq[n++] = 0x802c; //"all that follows is data"
+  return n;
+}
+
+void dispPlanRunTable(const DispRefreshPlan_t *plan, const uint8_t *framebuffer,
+                      uintptr_t *table) {
+  uint32_t i;
+
+  for (i = 0; i < plan->runs; i++)
+    table[i] = (uintptr_t)(framebuffer + plan->fbOffset + i * plan->runStride);
+  table[i] = 0;
+}
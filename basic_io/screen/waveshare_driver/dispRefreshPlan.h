@@ -0,0 +1,70 @@
+#ifndef _DISP_REFRESH_PLAN_H_
+#define _DISP_REFRESH_PLAN_H_
+
+// Works out what it takes to send one dirty rectangle to the panel: the
+// CASET/RASET window, which framebuffer bytes the DMA reads and how many bytes
+// go over the wire.  No hardware in here, so it can be checked on a host.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dispWaveshareLcd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CASET, RASET and RAMWR, in the same "high bit means command" form as the
+// init sequence
+#define DISP_PLAN_WINDOW_SEQ_LEN (11)
+
+typedef struct {
+  // panel window, already offset to where the virtual screen sits
+  uint16_t panelCol;
+  uint16_t panelRow;
+  uint16_t width;
+  uint16_t height;
+
+  // framebuffer side: `runs` runs of `runXfers` DMA transfers each, the first
+  // starting `fbOffset` bytes in, the next `runStride` bytes after that
+  uint32_t fbOffset;
+  uint32_t runStride;
+  uint32_t runs;
+  uint32_t runXfers;
+  uint32_t xferBytes;
+
+  // pixel bytes clocked out to the panel
+  uint32_t wireBytes;
+} DispRefreshPlan_t;
+
+// bytes per DMA transfer into the PIO: words, except halfwords at 16bpp
+uint32_t dispPlanXferBytes(uint8_t depth);
+
+// bytes on the wire for this many pixels: RGB444 for the grey modes, RGB565
+// for everything else
+uint32_t dispPlanWireBytes(uint8_t depth, uint32_t pixels);
+
+// Widen rect to whole DMA transfers and clip it to the virtual screen.
+//
+// When framebuffer rows are whole transfers, each row of the rectangle is a
+// run of its own.  When they are not (240 pixels at 1bpp is 30 bytes), the
+// rectangle grows to full rows, starting on a row that is transfer aligned.
+// A band of full rows is always a single run.
+//
+// Returns false if nothing of rect is on screen.
+bool dispPlanRefresh(const DispRect_t *rect, uint8_t depth,
+                     DispDimensions_t virt, DispDimensions_t phys,
+                     DispRefreshPlan_t *plan);
+
+// Fills seq with the window commands for plan, returns the length
+uint32_t dispPlanWindowSeq(const DispRefreshPlan_t *plan, uint16_t *seq);
+
+// Start address of each run, then a 0 to end the DMA chain.  table needs
+// plan->runs + 1 entries.
+void dispPlanRunTable(const DispRefreshPlan_t *plan, const uint8_t *framebuffer,
+                      uintptr_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
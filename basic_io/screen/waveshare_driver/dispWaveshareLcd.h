@@ -1,76 +1,133 @@
-//(c) 2023 Dmitry Grinberg  https://dmitry.gr
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-//
-//	Redistributions of source code must retain the above copyright notice,
-//this list 		of conditions and the following disclaimer. 	Redistributions in
-//binary form must reproduce the above copyright notice, this 		list of conditions
-//and the following disclaimer in the documentation and/or 		other materials
-//provided with the distribution.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
-// AND ANY
-//	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
-//IMPLIED 	WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-//DISCLAIMED. 	IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
-//FOR ANY DIRECT, 	INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
-//DAMAGES (INCLUDING, BUT 	NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
-//SERVICES; LOSS OF USE, DATA, OR 	PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
-//CAUSED AND ON ANY THEORY OF LIABILITY, 	WHETHER IN CONTRACT, STRICT LIABILITY,
-//OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 	ARISING IN ANY WAY OUT OF THE USE
-//OF THIS SOFTWARE, EVEN IF ADVISED OF THE 	POSSIBILITY OF SUCH DAMAGE.[
-
-#ifndef _DISP_WAVESHARE_LCD_H_
-#define _DISP_WAVESHARE_LCD_H_
-
-#include <stdbool.h>
-#include <stdint.h>
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// externally defined
-void dispExtTouchReport(int16_t x, int16_t y); // negative on pen up
-
-// structs
-typedef struct {
-  uint8_t r;
-  uint8_t g;
-  uint8_t b;
-} ClutEntry_t;
-
-// defined here
-typedef struct {
-  uint32_t width;
-  uint32_t height;
-} DispDimensions_t;
-
-void dispSetDepth(uint8_t depth);
-bool dispSetVirtualDimensions(DispDimensions_t virtual_size);
-bool dispSetPhysicalDimensions(DispDimensions_t physical_size);
-uint8_t dispGetDepth();
-DispDimensions_t dispGetVirtualDimensions();
-DispDimensions_t dispGetPhysicalDimensions();
-
-void dispSetClut(int32_t firstIdx, uint32_t numEntries,
-                 const ClutEntry_t *entries);
-void dispSetVideoBuffer(const uint8_t *framebuffer);
-const uint8_t *dispGetVideoBuffer();
-bool dispInit(const uint8_t *framebuffer, uint8_t depth,
-              DispDimensions_t virtual_size, DispDimensions_t physical_size);
-bool dispOn(void);
-bool dispOff(void);
-
-typedef struct {
-  uint32_t touch_zthresh;
-  uint8_t first_toss; // first this many points are tossed
-  uint8_t last_toss;  // then this many are averaged (and dropped at end)
-} dispTouchCfg_t;
-void dispConfigureTouch(dispTouchCfg_t cfg);
-void dispGetTouchConfiguration(dispTouchCfg_t *cfg);
-
-#ifdef __cplusplus
-}
-#endif
+//(c) 2023 Dmitry Grinberg  https://dmitry.gr
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//	Redistributions of source code must retain the above copyright notice,
+//this list 		of conditions and the following disclaimer. 	Redistributions in
+//binary form must reproduce the above copyright notice, this 		list of conditions
+//and the following disclaimer in the documentation and/or 		other materials
+//provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY
+//	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//IMPLIED 	WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//DISCLAIMED. 	IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+//FOR ANY DIRECT, 	INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//DAMAGES (INCLUDING, BUT 	NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//SERVICES; LOSS OF USE, DATA, OR 	PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//CAUSED AND ON ANY THEORY OF LIABILITY, 	WHETHER IN CONTRACT, STRICT LIABILITY,
+//OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 	ARISING IN ANY WAY OUT OF THE USE
+//OF THIS SOFTWARE, EVEN IF ADVISED OF THE 	POSSIBILITY OF SUCH DAMAGE.[
+
+#ifndef _DISP_WAVESHARE_LCD_H_
+#define _DISP_WAVESHARE_LCD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// externally defined
+void dispExtTouchReport(int16_t x, int16_t y); // negative on pen up
+
+// structs
+typedef struct {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+} ClutEntry_t;
+
+// depths: bits per pixel, with DISP_DEPTH_CLUT set when pixels index the CLUT
+// instead of being grey levels or RGB565
+#define DISP_DEPTH_CLUT (0x80)
+#define DISP_DEPTH_GREY1 (1)
+#define DISP_DEPTH_GREY2 (2)
+#define DISP_DEPTH_GREY4 (4)
+#define DISP_DEPTH_LUT1 (DISP_DEPTH_CLUT | 1)
+#define DISP_DEPTH_LUT2 (DISP_DEPTH_CLUT | 2)
+#define DISP_DEPTH_LUT4 (DISP_DEPTH_CLUT | 4)
+#define DISP_DEPTH_LUT8 (DISP_DEPTH_CLUT | 8)
+#define DISP_DEPTH_RGB565 (16)
+
+#define DISP_DEPTH_BPP(depth) ((depth) & ~DISP_DEPTH_CLUT)
+#define DISP_DEPTH_IS_CLUT(depth) (((depth) & DISP_DEPTH_CLUT) != 0)
+
+// defined here
+typedef struct {
+  uint32_t width;
+  uint32_t height;
+} DispDimensions_t;
+
+// in virtual screen pixels
+typedef struct {
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+} DispRect_t;
+
+typedef enum {
+  DispRefreshContinuous, // the whole framebuffer, over and over
+  DispRefreshOnDemand,   // only what dispRefreshRegions() is given
+} DispRefreshMode_t;
+
+// orientations: the panel's MADCTL bits.  Any mix of them works; with
+// DISP_ORIENT_SWAP_XY the physical and virtual dimensions read swapped.
+#define DISP_ORIENT_SWAP_XY (0x20)  // MV
+#define DISP_ORIENT_MIRROR_X (0x40) // MX
+#define DISP_ORIENT_MIRROR_Y (0x80) // MY
+
+void dispSetDepth(uint8_t depth);
+bool dispSetVirtualDimensions(DispDimensions_t virtual_size);
+// Both at once, with a single restart of the stream if either changed
+bool dispSetMode(uint8_t depth, DispDimensions_t virtual_size);
+bool dispSetPhysicalDimensions(DispDimensions_t physical_size);
+// Costs nothing per frame, the panel does the turning
+void dispSetOrientation(uint8_t orientation);
+uint8_t dispGetOrientation(void);
+uint8_t dispGetDepth();
+DispDimensions_t dispGetVirtualDimensions();
+DispDimensions_t dispGetPhysicalDimensions();
+
+void dispSetClut(int32_t firstIdx, uint32_t numEntries,
+                 const ClutEntry_t *entries);
+void dispSetVideoBuffer(const uint8_t *framebuffer);
+const uint8_t *dispGetVideoBuffer();
+bool dispInit(const uint8_t *framebuffer, uint8_t depth,
+              DispDimensions_t virtual_size, DispDimensions_t physical_size);
+bool dispOn(void);
+bool dispOff(void);
+
+void dispSetRefreshMode(DispRefreshMode_t mode);
+DispRefreshMode_t dispGetRefreshMode(void);
+// On demand only: send these parts of the framebuffer, return once they are
+// out.  In between, the pixel DMA is idle and only touch uses the bus.
+void dispRefreshRegions(const DispRect_t *rects, uint32_t numRects);
+// On demand only: send the whole framebuffer once
+void dispPresent(void);
+
+// what changing modes costs, in microseconds
+typedef struct {
+  uint32_t powerUpUs;    // last dispInit()/dispOn(): panel init and first frame
+  uint32_t blankUs;      // of dispInit()'s power up, clearing the whole panel
+  uint32_t switchUs;     // last depth or virtual size change while on
+  uint32_t switches;     // changes made while on
+  uint32_t colmodWrites; // of those, how many changed the panel's format
+} DispSwitchStats_t;
+void dispGetSwitchStats(DispSwitchStats_t *stats);
+
+typedef struct {
+  uint32_t touch_zthresh;
+  uint8_t first_toss; // first this many points are tossed
+  uint8_t last_toss;  // then this many are averaged (and dropped at end)
+} dispTouchCfg_t;
+void dispConfigureTouch(dispTouchCfg_t cfg);
+void dispGetTouchConfiguration(dispTouchCfg_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
 #endif
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include "screen_impl.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstring>
+
 // TODO consider not using the Pico SDK?
+#include "hardware/flash.h"
+#include "hardware/sync.h"
 #include "pico/printf.h"
 #include "pico/stdlib.h"
 
@@ -8,7 +14,18 @@
 #include "pinout.h"
 #include "screensize.h"
 
-#include "embp/circular_array.hpp"
+#include "embp/spsc_ring.hpp"
+
+/* how many touch reports can wait to be read, a power of two */
+#if !defined(TOUCH_QUEUE_DEPTH)
+#define TOUCH_QUEUE_DEPTH (32)
+#endif
+
+/* where in flash the touch calibration is kept, a whole sector of its own */
+#if !defined(TOUCH_CALIBRATION_FLASH_OFFSET)
+#define TOUCH_CALIBRATION_FLASH_OFFSET                                         \
+  (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#endif
 
 namespace screen_impl {
 namespace {
@@ -24,44 +41,131 @@ void setup_for_output(uint id) noexcept {
   gpio_set_dir(id, true);
 }
 
-[[nodiscard]] constexpr bool
-range_check_dimensions(Dimensions testdim) noexcept {
-  return testdim.width <= screen_impl::PHYSICAL_WIDTH_PIXELS &&
-         testdim.height <= screen_impl::PHYSICAL_HEIGHT_PIXELS;
+[[nodiscard]] bool range_check_dimensions(Dimensions testdim) noexcept {
+  const auto phys{get_physical_screen_size()};
+  return testdim.width <= phys.width && testdim.height <= phys.height;
 }
 
-} // namespace
+/* each quarter turn, as MADCTL bits; mirroring flips MX on top */
+constexpr std::array<uint8_t, 4> ORIENTATION_FLAGS{
+    0,
+    DISP_ORIENT_SWAP_XY | DISP_ORIENT_MIRROR_X,
+    DISP_ORIENT_MIRROR_X | DISP_ORIENT_MIRROR_Y,
+    DISP_ORIENT_SWAP_XY | DISP_ORIENT_MIRROR_Y,
+};
 
-void set_format(Format fmt) noexcept {
-  if (fmt == Format::RGB565) {
-    dispSetDepth(16);
-    return;
-  }
-  if (fmt == Format::RGB565_LUT4) {
-    dispSetDepth(5);
-    return;
+/* What the touch interrupt maps samples with: the calibration, turned to
+ * match the panel.  Two of them, so one can be rebuilt while the interrupt
+ * reads the other; the index is flipped once the new one is whole. */
+struct TouchMap {
+  TouchCalibration cal;
+  Dimensions limits;
+  bool raw;
+};
+TouchCalibration s_touch_cal{::screen::touch_calibration::DEFAULT};
+bool s_touch_raw{false};
+std::array<TouchMap, 2> s_touch_maps;
+uint32_t s_touch_map_idx{0};
+
+void update_touch_map() noexcept {
+  const uint8_t flags{dispGetOrientation()};
+  const uint32_t next{s_touch_map_idx ^ 1};
+  s_touch_maps[next] = {
+      .cal = ::screen::touch_calibration::reoriented(
+          s_touch_cal,
+          {.width = PHYSICAL_WIDTH_PIXELS, .height = PHYSICAL_HEIGHT_PIXELS},
+          (flags & DISP_ORIENT_SWAP_XY) != 0,
+          (flags & DISP_ORIENT_MIRROR_X) != 0,
+          (flags & DISP_ORIENT_MIRROR_Y) != 0),
+      .limits = get_physical_screen_size(),
+      .raw = s_touch_raw};
+  __atomic_store_n(&s_touch_map_idx, next, __ATOMIC_RELEASE);
+}
+
+[[nodiscard]] const ::screen::TouchCalibrationRecord &
+stored_touch_record() noexcept {
+  return *reinterpret_cast<const ::screen::TouchCalibrationRecord *>(
+      XIP_BASE + TOUCH_CALIBRATION_FLASH_OFFSET);
+}
+
+[[nodiscard]] constexpr uint8_t to_depth(Format fmt) noexcept {
+  switch (fmt) {
+  case Format::GREY1:
+    return DISP_DEPTH_GREY1;
+  case Format::GREY2:
+    return DISP_DEPTH_GREY2;
+  case Format::GREY4:
+    return DISP_DEPTH_GREY4;
+  case Format::RGB565_LUT2:
+    return DISP_DEPTH_LUT2;
+  case Format::RGB565_LUT4:
+    return DISP_DEPTH_LUT4;
+  case Format::RGB565_LUT8:
+    return DISP_DEPTH_LUT8;
+  case Format::RGB565:
+    return DISP_DEPTH_RGB565;
   }
-  dispSetDepth(screen::bitsizeof(fmt));
+  return DISP_DEPTH_RGB565;
 }
 
+} // namespace
+
+void set_format(Format fmt) noexcept { dispSetDepth(to_depth(fmt)); }
+
 Format get_format() noexcept {
-  const auto bpp = dispGetDepth();
-  switch (bpp) {
-  case 1U:
+  switch (dispGetDepth()) {
+  case DISP_DEPTH_GREY1:
     return Format::GREY1;
-  case 2U:
+  case DISP_DEPTH_GREY2:
     return Format::GREY2;
-  case 4U:
+  case DISP_DEPTH_GREY4:
     return Format::GREY4;
-  case 5U:
+  case DISP_DEPTH_LUT2:
+    return Format::RGB565_LUT2;
+  case DISP_DEPTH_LUT4:
     return Format::RGB565_LUT4;
-  case 8U:
+  case DISP_DEPTH_LUT8:
     return Format::RGB565_LUT8;
-  case 16U:
+  case DISP_DEPTH_RGB565:
     return Format::RGB565;
   }
   return Format::RGB565;
 }
+void set_orientation(Orientation orientation, bool mirrored) noexcept {
+  const uint8_t flags{ORIENTATION_FLAGS[static_cast<size_t>(orientation)]};
+  dispSetOrientation(mirrored ? flags ^ DISP_ORIENT_MIRROR_X : flags);
+  update_touch_map();
+}
+Orientation get_orientation() noexcept {
+  const uint8_t flags{dispGetOrientation()};
+  for (size_t idx = 0; idx < std::size(ORIENTATION_FLAGS); ++idx) {
+    if (flags == ORIENTATION_FLAGS[idx] ||
+        flags == (ORIENTATION_FLAGS[idx] ^ DISP_ORIENT_MIRROR_X)) {
+      return static_cast<Orientation>(idx);
+    }
+  }
+  return Orientation::PORTRAIT;
+}
+bool get_mirrored() noexcept {
+  const uint8_t flags{dispGetOrientation()};
+  return flags != ORIENTATION_FLAGS[static_cast<size_t>(get_orientation())];
+}
+Dimensions get_physical_screen_size() noexcept {
+  if (dispGetOrientation() & DISP_ORIENT_SWAP_XY) {
+    return {.width = PHYSICAL_HEIGHT_PIXELS, .height = PHYSICAL_WIDTH_PIXELS};
+  }
+  return {.width = PHYSICAL_WIDTH_PIXELS, .height = PHYSICAL_HEIGHT_PIXELS};
+}
+
+ModeSwitchStats get_mode_switch_stats() noexcept {
+  DispSwitchStats_t stats;
+  dispGetSwitchStats(&stats);
+  return {.power_up_us = stats.powerUpUs,
+          .blank_us = stats.blankUs,
+          .switch_us = stats.switchUs,
+          .switches = stats.switches,
+          .colmod_writes = stats.colmodWrites};
+}
 Dimensions get_virtual_screen_size() noexcept {
   const auto dims{dispGetVirtualDimensions()};
   return {.width = dims.width, .height = dims.height};
@@ -72,6 +176,14 @@ void set_virtual_screen_size([[maybe_unused]] Position new_topleft,
       {.width = new_size.width, .height = new_size.height});
 }
 
+bool set_mode(Format format, Dimensions virtual_size) noexcept {
+  if (!range_check_dimensions(virtual_size)) {
+    return false;
+  }
+  return dispSetMode(to_depth(format), {.width = virtual_size.width,
+                                        .height = virtual_size.height});
+}
+
 const uint8_t *get_video_buffer() noexcept { return dispGetVideoBuffer(); }
 
 bool init(const uint8_t *video_buf, [[maybe_unused]] Position virtual_topleft,
@@ -92,13 +204,20 @@ bool init(const uint8_t *video_buf, [[maybe_unused]] Position virtual_topleft,
   setup_for_output(PIN_LCD_BL);
 
   status &=
-      dispInit(video_buf, screen::bitsizeof(format),
+      dispInit(video_buf, to_depth(format),
                {.width = virtual_size.width, .height = virtual_size.height},
                {.width = screen_impl::PHYSICAL_WIDTH_PIXELS,
                 .height = screen_impl::PHYSICAL_HEIGHT_PIXELS});
 
   gpio_put(PIN_LCD_BL, true);
 
+  /* a calibration saved earlier, otherwise the built in one */
+  if (TouchCalibration stored;
+      ::screen::touch_calibration::read_record(stored_touch_record(), stored)) {
+    s_touch_cal = stored;
+  }
+  update_touch_map();
+
   return status;
 }
 
@@ -113,15 +232,75 @@ void set_video_buffer(const uint8_t *buffer) noexcept {
   dispSetVideoBuffer(buffer);
 }
 
-static embp::circular_array<TouchReport, 1> s_touch_ring(1);
+void set_refresh_mode(RefreshMode mode) noexcept {
+  dispSetRefreshMode(mode == RefreshMode::ON_DEMAND ? DispRefreshOnDemand
+                                                    : DispRefreshContinuous);
+}
+
+RefreshMode get_refresh_mode() noexcept {
+  return dispGetRefreshMode() == DispRefreshOnDemand ? RefreshMode::ON_DEMAND
+                                                     : RefreshMode::CONTINUOUS;
+}
+
+void refresh(const Region *regions, uint32_t count) noexcept {
+  static_assert(sizeof(Region) == sizeof(DispRect_t));
+  const auto *p_rects{
+      static_cast<const DispRect_t *>(static_cast<const void *>(regions))};
+  dispRefreshRegions(p_rects, count);
+}
+
+void present() noexcept { dispPresent(); }
+
+/* filled from the touch interrupt, emptied by whoever reads touch */
+static embp::spsc_ring<TouchReport, TOUCH_QUEUE_DEPTH> s_touch_ring;
 [[nodiscard]] bool get_touch_report(TouchReport &out) {
+  return s_touch_ring.pop(out);
+}
+[[nodiscard]] uint32_t get_touch_reports(TouchReport *out, uint32_t max_count) {
+  return s_touch_ring.pop(out, max_count);
+}
+[[nodiscard]] uint32_t get_touch_reports_dropped() noexcept {
+  return s_touch_ring.dropped();
+}
 
-  if (s_touch_ring.empty()) {
-    return false;
+void set_touch_calibration(const TouchCalibration &cal) noexcept {
+  s_touch_cal = cal;
+  update_touch_map();
+}
+TouchCalibration get_touch_calibration() noexcept { return s_touch_cal; }
+void set_touch_raw(bool raw) noexcept {
+  s_touch_raw = raw;
+  update_touch_map();
+}
+
+/* Erasing and programming stall XIP, so nothing may run from flash
+ * meanwhile: interrupts are held off here, and core 1 has to be parked by the
+ * caller.  The pixel and touch DMA only touch RAM and carry on. */
+bool save_touch_calibration() noexcept {
+  namespace tc = ::screen::touch_calibration;
+  auto &&is_stored{[] {
+    TouchCalibration stored;
+    return tc::read_record(stored_touch_record(), stored) &&
+           std::memcmp(&stored, &s_touch_cal, sizeof(stored)) == 0;
+  }};
+  /* spare the flash a write */
+  if (is_stored()) {
+    return true;
   }
-  out = s_touch_ring.front();
-  s_touch_ring.pop_front();
-  return true;
+
+  std::array<uint8_t, FLASH_PAGE_SIZE> page;
+  page.fill(0xFF);
+  const auto record{tc::make_record(s_touch_cal)};
+  static_assert(sizeof(record) <= FLASH_PAGE_SIZE);
+  std::memcpy(std::data(page), &record, sizeof(record));
+
+  const auto interrupts{save_and_disable_interrupts()};
+  flash_range_erase(TOUCH_CALIBRATION_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(TOUCH_CALIBRATION_FLASH_OFFSET, std::data(page),
+                      std::size(page));
+  restore_interrupts(interrupts);
+
+  return is_stored();
 }
 
 /** @brief Hook into DmitryGR's Waveshare LCD/touchscreen driver
@@ -134,18 +313,30 @@ static embp::circular_array<TouchReport, 1> s_touch_ring(1);
  *
  * This callback ONLY gets called when someone is pushing the screen.
  * So it seems that when this happens, we push the latest active sample
- * into a ring buffer with a timestamp.
+ * into a ring buffer with a timestamp.  If the reader has fallen behind and
+ * the ring is full, the sample is dropped and counted.
+ *
+ * Samples are mapped to pixels on the way in, unless raw ones were asked for.
+ * The map is all integer, a handful of multiplies.
  *
  * @param x Column location of next sample, negative on pen up
  * @param y Row location of next sample, negative on pen up
  */
 extern "C" {
 void dispExtTouchReport(int16_t x, int16_t y) {
-  const auto report{TouchReport{.x = x,
-                                .y = y,
-                                .pen_up = x < 0 || y < 0
-                                /*,.timestamp = get_absolute_time()*/}};
-  s_touch_ring.push_back(report);
+  auto report{TouchReport{.x = x,
+                          .y = y,
+                          .pen_up = x < 0 || y < 0,
+                          .timestamp_us = time_us_32()}};
+  const auto &active{
+      s_touch_maps[__atomic_load_n(&s_touch_map_idx, __ATOMIC_ACQUIRE)]};
+  if (!report.pen_up && !active.raw) {
+    const auto mapped{
+        ::screen::touch_calibration::map(active.cal, x, y, active.limits)};
+    report.x = mapped.x;
+    report.y = mapped.y;
+  }
+  s_touch_ring.push(report);
 }
 }
 
@@ -6,13 +6,19 @@
 #include "pico/time.h"
 
 #include "../screen_def.h"
+#include "../touch_calibration.hpp"
 
 namespace screen_impl {
 
 using ::screen::Clut;
 using ::screen::Dimensions;
 using ::screen::Format;
+using ::screen::ModeSwitchStats;
+using ::screen::Orientation;
 using ::screen::Position;
+using ::screen::RefreshMode;
+using ::screen::Region;
+using ::screen::TouchCalibration;
 using ::screen::TouchReport;
 
 [[nodiscard]] bool init(const uint8_t *video_buf, Position virtual_topleft,
@@ -26,11 +32,32 @@ void set_video_buffer(const uint8_t *buffer) noexcept;
 [[nodiscard]] Format get_format() noexcept;
 void set_format(Format) noexcept;
 
+[[nodiscard]] ModeSwitchStats get_mode_switch_stats() noexcept;
+
+void set_orientation(Orientation orientation, bool mirrored) noexcept;
+[[nodiscard]] Orientation get_orientation() noexcept;
+[[nodiscard]] bool get_mirrored() noexcept;
+[[nodiscard]] Dimensions get_physical_screen_size() noexcept;
+
 [[nodiscard]] Dimensions get_virtual_screen_size() noexcept;
 void set_virtual_screen_size(Position new_topleft,
                              Dimensions new_size) noexcept;
+/** @brief Format and virtual size together, as a single switch. */
+[[nodiscard]] bool set_mode(Format format, Dimensions virtual_size) noexcept;
+
+void set_refresh_mode(RefreshMode mode) noexcept;
+[[nodiscard]] RefreshMode get_refresh_mode() noexcept;
+void refresh(const Region *regions, uint32_t count) noexcept;
+void present() noexcept;
 
 [[nodiscard]] bool get_touch_report(TouchReport &out);
+[[nodiscard]] uint32_t get_touch_reports(TouchReport *out, uint32_t max_count);
+[[nodiscard]] uint32_t get_touch_reports_dropped() noexcept;
+
+void set_touch_calibration(const TouchCalibration &cal) noexcept;
+[[nodiscard]] TouchCalibration get_touch_calibration() noexcept;
+void set_touch_raw(bool raw) noexcept;
+[[nodiscard]] bool save_touch_calibration() noexcept;
 
 } // namespace screen_impl
 #endif
\ No newline at end of file
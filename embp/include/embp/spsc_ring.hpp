@@ -0,0 +1,105 @@
+#pragma once
+#ifdef STD_LIB_AVAILABLE
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+// Single producer, single consumer ring, for handing data out of an interrupt.
+// Each index has one writer and is only ever loaded or stored whole, never
+// read-modify-written, so no locks and no exclusive access instructions: safe
+// on a Cortex-M0+.  The indices run free and wrap on their own, which is why
+// Capacity must be a power of two; all Capacity slots are usable.
+// When full, push() drops the new element and counts it.
+
+namespace embp
+{
+
+template < class DataType, size_t Capacity >
+struct spsc_ring
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    using value_type = DataType;
+    using size_type = size_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+
+private:
+    value_type data_[Capacity];
+    size_type head_{0};    // next to write, producer's
+    size_type tail_{0};    // next to read, consumer's
+    size_type dropped_{0}; // producer's
+
+    [[nodiscard]] static size_type load_acquire(const size_type &idx) noexcept
+    {
+        return __atomic_load_n(&idx, __ATOMIC_ACQUIRE);
+    }
+    static void store_release(size_type &idx, const size_type val) noexcept
+    {
+        __atomic_store_n(&idx, val, __ATOMIC_RELEASE);
+    }
+
+public:
+    [[nodiscard]] constexpr size_type capacity() const noexcept
+    {
+        return Capacity;
+    }
+
+    /* producer side */
+
+    // false, and the element counted as dropped, if there was no room
+    bool push(const_reference value) noexcept
+    {
+        const size_type head = head_;
+        if(head - load_acquire(tail_) == Capacity)
+        {
+            store_release(dropped_, dropped_ + 1);
+            return false;
+        }
+        data_[head & (Capacity - 1)] = value;
+        store_release(head_, head + 1);
+        return true;
+    }
+
+    /* consumer side */
+
+    // false if there was nothing to pop
+    [[nodiscard]] bool pop(reference out) noexcept
+    {
+        return pop(&out, 1) == 1;
+    }
+
+    // up to max_count of the oldest elements, oldest first; returns how many
+    [[nodiscard]] size_type pop(pointer out, const size_type max_count) noexcept
+    {
+        const size_type tail = tail_;
+        size_type count = load_acquire(head_) - tail;
+        if(count > max_count)
+            count = max_count;
+        for(size_type ii = 0; ii < count; ++ii)
+            out[ii] = data_[(tail + ii) & (Capacity - 1)];
+        store_release(tail_, tail + count);
+        return count;
+    }
+
+    /* either side, though the answer can be stale by the time it is used */
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return load_acquire(head_) - load_acquire(tail_);
+    }
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+    // since construction, wrapping; compare against an earlier reading
+    [[nodiscard]] size_type dropped() const noexcept
+    {
+        return load_acquire(dropped_);
+    }
+};
+
+} // namespace embp
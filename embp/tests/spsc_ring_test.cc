@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "embp/spsc_ring.hpp"
+
+TEST(SpscRing, Construction)
+{
+    embp::spsc_ring<int, 8> t;
+    EXPECT_EQ(t.capacity(), 8);
+    EXPECT_EQ(t.size(), 0);
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(t.dropped(), 0);
+
+    int out = -1;
+    EXPECT_FALSE(t.pop(out));
+    EXPECT_EQ(out, -1);
+}
+
+TEST(SpscRing, PushPop_InOrder)
+{
+    embp::spsc_ring<int, 8> t;
+    for(int ii = 0; ii < 5; ++ii)
+        EXPECT_TRUE(t.push(ii));
+    EXPECT_EQ(t.size(), 5);
+
+    for(int ii = 0; ii < 5; ++ii)
+    {
+        int out = -1;
+        EXPECT_TRUE(t.pop(out));
+        EXPECT_EQ(out, ii);
+    }
+    EXPECT_TRUE(t.empty());
+}
+
+TEST(SpscRing, Full_DropsNewestAndCounts)
+{
+    constexpr size_t N = 4;
+    embp::spsc_ring<int, N> t;
+    for(size_t ii = 0; ii < N; ++ii)
+        EXPECT_TRUE(t.push(static_cast<int>(ii)));
+    EXPECT_EQ(t.size(), N);
+
+    EXPECT_FALSE(t.push(100));
+    EXPECT_FALSE(t.push(101));
+    EXPECT_EQ(t.dropped(), 2);
+    EXPECT_EQ(t.size(), N);
+
+    // what was there survives, the drops never show up
+    int out = -1;
+    for(size_t ii = 0; ii < N; ++ii)
+    {
+        EXPECT_TRUE(t.pop(out));
+        EXPECT_EQ(out, static_cast<int>(ii));
+    }
+    EXPECT_FALSE(t.pop(out));
+
+    // and room again
+    EXPECT_TRUE(t.push(7));
+    EXPECT_EQ(t.dropped(), 2);
+}
+
+TEST(SpscRing, WrapsManyTimes)
+{
+    embp::spsc_ring<unsigned, 4> t;
+    unsigned next_in = 0, next_out = 0;
+    for(int round = 0; round < 1000; ++round)
+    {
+        // uneven amounts, so head and tail land everywhere in the storage
+        for(int ii = 0; ii < 1 + round % 4; ++ii)
+            EXPECT_TRUE(t.push(next_in++));
+        for(int ii = 0; ii < 1 + round % 4; ++ii)
+        {
+            unsigned out = 0;
+            EXPECT_TRUE(t.pop(out));
+            EXPECT_EQ(out, next_out++);
+        }
+    }
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(t.dropped(), 0);
+}
+
+TEST(SpscRing, BatchPop)
+{
+    embp::spsc_ring<int, 8> t;
+    for(int ii = 0; ii < 6; ++ii)
+        t.push(ii);
+
+    int out[8] = {};
+    EXPECT_EQ(t.pop(out, 4), 4);
+    for(int ii = 0; ii < 4; ++ii)
+        EXPECT_EQ(out[ii], ii);
+
+    // asking for more than there is gets what there is
+    EXPECT_EQ(t.pop(out, 8), 2);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[1], 5);
+    EXPECT_EQ(t.pop(out, 8), 0);
+}
+
+TEST(SpscRing, BatchPop_AcrossTheWrap)
+{
+    embp::spsc_ring<int, 4> t;
+    int out[4] = {};
+    for(int ii = 0; ii < 3; ++ii)
+        t.push(ii);
+    EXPECT_EQ(t.pop(out, 3), 3);
+
+    // storage slots 3, 0, 1, 2
+    for(int ii = 10; ii < 14; ++ii)
+        EXPECT_TRUE(t.push(ii));
+    EXPECT_EQ(t.pop(out, 4), 4);
+    for(int ii = 0; ii < 4; ++ii)
+        EXPECT_EQ(out[ii], 10 + ii);
+}
+
+TEST(SpscRing, TwoThreads_NothingLostUncounted)
+{
+    // the producer stands in for an interrupt handler: it never waits
+    constexpr unsigned COUNT = 200000;
+    embp::spsc_ring<unsigned, 16> t;
+    std::atomic<bool> done{false};
+    unsigned pushed = 0;
+
+    std::thread producer([&]
+    {
+        for(unsigned ii = 0; ii < COUNT; ++ii)
+            pushed += t.push(ii);
+        done = true;
+    });
+
+    std::vector<unsigned> received;
+    unsigned batch[5];
+    for(;;)
+    {
+        const bool last = done;
+        const size_t n = t.pop(batch, 5);
+        received.insert(received.end(), batch, batch + n);
+        if(last && n == 0)
+            break;
+    }
+    producer.join();
+
+    EXPECT_EQ(received.size(), pushed);
+    EXPECT_EQ(received.size() + t.dropped(), COUNT);
+    for(size_t ii = 1; ii < received.size(); ++ii)
+        EXPECT_LT(received[ii - 1], received[ii]);
+}
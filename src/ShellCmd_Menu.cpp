@@ -2,13 +2,14 @@
 
 #include <array>
 #include <cstdint>
-#include <cstring>
 #include <utility>
 
 #include "pico/time.h"
 
+#include "bsio.hpp"
 #include "common/Cursor.hpp"
 #include "demo.hpp"
+#include "gamepad/button_events.hpp"
 #include "gamepad/gamepad.hpp"
 #include "revenge/revenge.hpp"
 #include "screen/screen.hpp"
@@ -69,42 +70,32 @@ void init_menu_cfg() noexcept {
   g_cfg.titlestartline = 1;
 }
 
+/* holding up or down scrolls, holding etc launches just the once */
 [[nodiscard]] UserInstruction process_user_input() noexcept {
-  UserInstruction result{UserInstruction::NOACTION};
-  auto state{gamepad::five::get()};
+  using gamepad::five::Button;
+  using gamepad::five::EventKind;
 
-  if (state.up) {
-    result = UserInstruction::CURSOR_UP;
-  }
-  if (state.down) {
-    result = UserInstruction::CURSOR_DOWN;
-  }
-  if (state.etc) {
-    result = UserInstruction::LAUNCH_PROGRAM;
-  }
-
-  if (result == UserInstruction::NOACTION) {
-    return result;
-  }
-
-  /* in case a button is still pressed, spin until they are all clear */
-  bool triggered{false};
-  for (;;) {
-    state = gamepad::five::get();
-
-    uint8_t data;
-    std::memcpy(&data, &state, sizeof(state));
-    if (!data && triggered == false) {
-      triggered = true;
-    } else if (data && triggered == true) {
-      triggered = false;
-    } else if (!data && triggered == true) {
+  gamepad::five::Event event;
+  while (gamepad::five::get_event(event)) {
+    if (event.kind == EventKind::RELEASE) {
+      continue;
+    }
+    switch (event.button) {
+    case Button::UP:
+      return UserInstruction::CURSOR_UP;
+    case Button::DOWN:
+      return UserInstruction::CURSOR_DOWN;
+    case Button::ETC:
+      if (event.kind == EventKind::PRESS) {
+        return UserInstruction::LAUNCH_PROGRAM;
+      }
+      break;
+    case Button::LEFT:
+    case Button::RIGHT:
       break;
     }
-    sleep_ms(10);
   }
-
-  return result;
+  return UserInstruction::NOACTION;
 }
 
 void draw_menu() noexcept {
@@ -143,7 +134,8 @@ void draw_menu() noexcept {
   }
 }
 
-void update_selection() noexcept {
+/* true if anything was redrawn */
+[[nodiscard]] bool update_selection() noexcept {
   if (g_prev_cursor != g_cursor) {
     /* actually update the screen*/
     const uint32_t xpos{g_cfg.startcol};
@@ -160,7 +152,9 @@ void update_selection() noexcept {
     screen::draw_letter(xpos + 1, ypos, '*');
 
     g_prev_cursor = g_cursor;
+    return true;
   }
+  return false;
 }
 
 } // namespace
@@ -178,7 +172,6 @@ int ShellCmd_Menu(int, const char *[]) noexcept {
   /* initialize the menu configuration */
   init_menu_cfg();
   g_keep_running = true;
-  bool wait_for_noaction{true};
   while (g_keep_running) {
 
     g_prev_cursor = MENU_LIMIT;
@@ -187,13 +180,21 @@ int ShellCmd_Menu(int, const char *[]) noexcept {
     if (!screen::set_console_mode()) {
       return -1;
     }
+    /* the menu sits still most of the time, only send it when it changes */
+    screen::set_refresh_mode(screen::RefreshMode::ON_DEMAND);
     draw_menu();
+    /* sent below whether or not the cursor moved */
+    static_cast<void>(update_selection());
+    screen::present();
+    bsio::mark_boot_phase(bsio::BootPhase::MENU);
 
     bool in_menu{true};
     while (in_menu) {
 
       /* draw the menu */
-      update_selection();
+      if (update_selection()) {
+        screen::present();
+      }
 
       /* read user input
        * if "up" or "down", move selection cursor
@@ -204,33 +205,29 @@ int ShellCmd_Menu(int, const char *[]) noexcept {
       const UserInstruction input{process_user_input()};
       switch (input) {
       case UserInstruction::CURSOR_UP:
-        if (!wait_for_noaction) {
-          g_cursor--;
-          wait_for_noaction = true;
-        }
+        g_cursor--;
         break;
       case UserInstruction::CURSOR_DOWN:
-        if (!wait_for_noaction) {
-          g_cursor++;
-          wait_for_noaction = true;
-        }
+        g_cursor++;
         break;
       case UserInstruction::LAUNCH_PROGRAM:
-        if (!wait_for_noaction) {
-          g_f_table[g_cursor].second();
-          gamepad::five::init();
-          in_menu = false;
-          wait_for_noaction = true;
-        }
+        screen::set_refresh_mode(screen::RefreshMode::CONTINUOUS);
+        g_f_table[g_cursor].second();
+        gamepad::five::init();
+        /* whatever the program left unread isn't for the menu */
+        gamepad::five::flush_events();
+        in_menu = false;
         break;
       case UserInstruction::NOACTION:
-        wait_for_noaction = false;
+        /* events come in every poll, no sooner */
+        sleep_ms(1);
         break;
       }
     }
   }
 
   gamepad::five::deinit();
+  screen::set_refresh_mode(screen::RefreshMode::CONTINUOUS);
   screen::clear_console();
 
   return 0;
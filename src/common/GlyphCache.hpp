@@ -0,0 +1,215 @@
+#if !defined(GLYPHCACHE_HPP)
+#define GLYPHCACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "screen/TileDef.h"
+#include "screen/glyphs/letters.hpp"
+#include "screen/screen_def.h"
+
+/** @brief Small cache of ASCII glyphs already expanded to a color format.
+ *
+ * Keyed by (character, foreground, background, format, scale).  On a miss the
+ * least recently used slot is overwritten.  Tiles handed out point into the
+ * cache, so draw them before asking for CAPACITY more glyphs.
+ *
+ * @tparam CAPACITY Number of glyphs held at once
+ * @tparam MAX_SCALE Largest integer scale factor that will be requested
+ * @tparam MAX_BPP Widest pixel format that will be requested (up to 8)
+ */
+template <size_t CAPACITY, size_t MAX_SCALE = 1, size_t MAX_BPP = 4>
+class GlyphCache final {
+public:
+  static_assert(CAPACITY > 0);
+  static_assert(MAX_BPP == 1 || MAX_BPP == 2 || MAX_BPP == 4 || MAX_BPP == 8);
+
+  struct Stats {
+    uint32_t hits;
+    uint32_t misses;
+  };
+
+  /** @brief Fetch a ready-to-draw glyph, expanding it on a miss.
+   *
+   * @param c Ascii encoding, please
+   * @param foreground Pixel value for set glyph bits
+   * @param background Pixel value for unset glyph bits
+   * @param format Pixel format of the output tile.  Must be at most MAX_BPP.
+   * @param scale Each glyph pixel becomes a scale x scale block. 1..MAX_SCALE
+   *
+   * @return Tile of side glyphs::tile::width() * scale.  Has side_length of 0
+   * if the format or scale are out of range for this cache.
+   */
+  [[nodiscard]] constexpr screen::Tile get(char c, uint8_t foreground,
+                                           uint8_t background,
+                                           screen::Format format,
+                                           uint8_t scale = 1) noexcept {
+    if (screen::bitsizeof(format) > MAX_BPP || scale == 0 ||
+        scale > MAX_SCALE) {
+      return {.side_length = 0, .format = format, .data = nullptr};
+    }
+
+    const Key key{.c = c,
+                  .foreground = foreground,
+                  .background = background,
+                  .format = format,
+                  .scale = scale};
+    ++m_tick;
+
+    size_t victim{0};
+    for (size_t idx = 0; idx < CAPACITY; ++idx) {
+      auto &slot{m_slots[idx]};
+      if (slot.valid && slot.key == key) {
+        slot.last_used = m_tick;
+        ++m_stats.hits;
+        return to_tile(slot);
+      }
+      if (!slot.valid) {
+        victim = idx;
+      } else if (m_slots[victim].valid &&
+                 slot.last_used < m_slots[victim].last_used) {
+        victim = idx;
+      }
+    }
+
+    ++m_stats.misses;
+    auto &slot{m_slots[victim]};
+    slot.key = key;
+    slot.valid = true;
+    slot.last_used = m_tick;
+    expand(slot);
+    return to_tile(slot);
+  }
+
+  /** @brief Forget every glyph.  Counters are kept. */
+  constexpr void clear() noexcept {
+    for (auto &slot : m_slots) {
+      slot.valid = false;
+    }
+  }
+
+  [[nodiscard]] constexpr Stats stats() const noexcept { return m_stats; }
+
+  constexpr void reset_stats() noexcept { m_stats = {}; }
+
+private:
+  static constexpr size_t GLYPH_WIDTH{glyphs::tile::width()};
+  static constexpr size_t GLYPH_HEIGHT{glyphs::tile::height()};
+  static constexpr size_t SLOT_BYTES{GLYPH_WIDTH * MAX_SCALE * GLYPH_HEIGHT *
+                                     MAX_SCALE * MAX_BPP / 8};
+
+  struct Key {
+    char c;
+    uint8_t foreground;
+    uint8_t background;
+    screen::Format format;
+    uint8_t scale;
+
+    [[nodiscard]] constexpr bool operator==(const Key &) const = default;
+  };
+
+  struct Slot {
+    Key key{};
+    bool valid{false};
+    uint32_t last_used{0};
+    std::array<uint8_t, SLOT_BYTES> data{};
+  };
+
+  [[nodiscard]] static constexpr screen::Tile
+  to_tile(const Slot &slot) noexcept {
+    return {.side_length =
+                static_cast<uint8_t>(GLYPH_WIDTH * slot.key.scale),
+            .format = slot.key.format,
+            .data = std::data(slot.data)};
+  }
+
+  /** @brief 1bpp glyph -> format-sized pixels, pixel 0 in the low bits */
+  static constexpr void expand(Slot &slot) noexcept {
+    const auto &letter{glyphs::decode_ascii(slot.key.c)};
+    const uint32_t bpp{static_cast<uint32_t>(screen::bitsizeof(slot.key.format))};
+    const uint32_t scale{slot.key.scale};
+    const uint32_t side{static_cast<uint32_t>(GLYPH_WIDTH * scale)};
+
+    for (auto &byte : slot.data) {
+      byte = 0;
+    }
+    uint32_t bit{0};
+    for (uint32_t yy = 0; yy < side; ++yy) {
+      const auto inrow{letter[yy / scale]};
+      for (uint32_t xx = 0; xx < side; ++xx) {
+        const bool set{((inrow >> (xx / scale)) & 0b1) == 1};
+        const uint32_t value{set ? slot.key.foreground : slot.key.background};
+        slot.data[bit >> 3] |= static_cast<uint8_t>(
+            (value & ((1U << bpp) - 1)) << (bit & 7));
+        bit += bpp;
+      }
+    }
+  }
+
+  std::array<Slot, CAPACITY> m_slots{};
+  uint32_t m_tick{0};
+  Stats m_stats{};
+};
+
+namespace constexpr_testing {
+
+static constexpr bool run_glyph_cache_test() {
+  bool status{true};
+
+  /* hits, misses and least-recently-used eviction */
+  {
+    GlyphCache<2> dut{};
+    const auto fmt{screen::Format::RGB565_LUT4};
+
+    const auto a0{dut.get('0', 0xF, 0x0, fmt)};
+    status &= dut.stats().misses == 1;
+    const auto a1{dut.get('0', 0xF, 0x0, fmt)};
+    status &= dut.stats().hits == 1;
+    status &= a0.data == a1.data;
+
+    /* a different color is a different glyph */
+    const auto b0{dut.get('0', 0x3, 0x0, fmt)};
+    status &= dut.stats().misses == 2;
+    status &= b0.data != a0.data;
+
+    /* '0'/0xF was used before '0'/0x3, so it goes first */
+    static_cast<void>(dut.get('1', 0xF, 0x0, fmt));
+    status &= dut.stats().misses == 3;
+    static_cast<void>(dut.get('0', 0x3, 0x0, fmt));
+    status &= dut.stats().hits == 2;
+    static_cast<void>(dut.get('0', 0xF, 0x0, fmt));
+    status &= dut.stats().misses == 4;
+  }
+
+  /* expansion matches copy-and-double, with pixel 0 in the low nibble */
+  {
+    GlyphCache<1, 2> dut{};
+    const auto &letter{glyphs::decode_ascii('7')};
+    const auto tile{dut.get('7', 0xA, 0x5, screen::Format::RGB565_LUT4, 2)};
+    status &= tile.side_length == 16;
+    for (uint32_t yy = 0; yy < 16; ++yy) {
+      for (uint32_t xx = 0; xx < 16; ++xx) {
+        const uint32_t linidx{yy * 16 + xx};
+        const uint32_t nibble{
+            static_cast<uint32_t>(tile.data[linidx >> 1] >> ((xx & 1) * 4)) &
+            0xF};
+        const bool set{((letter[yy >> 1] >> (xx >> 1)) & 0b1) == 1};
+        status &= nibble == (set ? 0xAU : 0x5U);
+      }
+    }
+  }
+
+  /* out of range requests come back empty */
+  {
+    GlyphCache<1> dut{};
+    status &= dut.get('a', 1, 0, screen::Format::RGB565).side_length == 0;
+    status &= dut.get('a', 1, 0, screen::Format::GREY1, 2).side_length == 0;
+  }
+
+  return status;
+}
+static_assert(run_glyph_cache_test());
+
+} // namespace constexpr_testing
+#endif
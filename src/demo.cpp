@@ -1,5 +1,6 @@
 #include "demo.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
@@ -169,6 +170,10 @@ void run_color_rando_art() noexcept {
                              1);
       screen::gfx::draw_line({.x = 100, .y = 100}, {.x = 90, .y = 25}, color,
                              1);
+
+      /* round things, one solid and one ring around it */
+      screen::gfx::draw_circle({.x = 170, .y = 240}, 30, color, 0);
+      screen::gfx::draw_circle({.x = 170, .y = 240}, 45, color, 1 + (r >> 2));
     }
   }};
 
@@ -229,9 +234,20 @@ void run_linebounce_screensaver() noexcept {
       Velocity{.dx = -10000, .dy = -11000},
   };
 
+  /* the demo colors, then an 8 step ramp from black to the line color */
+  std::array<screen::Clut, 16> palette{};
+  std::copy(std::begin(Demo_Palette), std::end(Demo_Palette),
+            std::begin(palette));
+  constexpr uint32_t RAMP_BASE{8};
+  constexpr uint32_t RAMP_LEVELS{8};
+  const screen::gfx::IntensityRamp erase{.base = BLACK, .levels = 1};
+
   screen::clear_screen();
   screen::set_format(screen::Format::RGB565_LUT4);
-  screen::init_clut(std::data(Demo_Palette), std::size(Demo_Palette));
+  auto color{RED};
+  const auto ramp{screen::gfx::load_intensity_ramp(
+      std::data(palette), std::size(palette), RAMP_BASE, RAMP_LEVELS,
+      Demo_Palette[BLACK], Demo_Palette[color])};
   screen::fill_screen(BLACK | (BLACK << 4));
 
   Timer<timer_details::PicoSdk> button_timer{1000};
@@ -239,7 +255,11 @@ void run_linebounce_screensaver() noexcept {
   Timer<timer_details::PicoSdk> update_timer{1 << 14};
   std::array<screen::gfx::Point, 4> prvpoints{};
   std::array<screen::gfx::Point, 4> points{};
-  auto color{RED};
+  /* 'up' steps through outline, filled and anti-aliased */
+  enum struct Mode { OUTLINE, FILLED, ANTI_ALIASED };
+  Mode mode{Mode::OUTLINE};
+  bool prev_up{false};
+  uint32_t ramp_color{color};
   for (;;) {
     if (update_timer.elapsed()) {
       update_timer.reset();
@@ -263,14 +283,39 @@ void run_linebounce_screensaver() noexcept {
         points[ii].y = linep[ii].y >> 14;
       }
 
-      screen::gfx::draw_line(prvpoints[0], prvpoints[1], BLACK, 1);
-      screen::gfx::draw_line(points[0], points[1], color, 1);
-      screen::gfx::draw_line(prvpoints[1], prvpoints[2], BLACK, 1);
-      screen::gfx::draw_line(points[1], points[2], color, 1);
-      screen::gfx::draw_line(prvpoints[2], prvpoints[3], BLACK, 1);
-      screen::gfx::draw_line(points[2], points[3], color, 1);
-      screen::gfx::draw_line(prvpoints[3], prvpoints[0], BLACK, 1);
-      screen::gfx::draw_line(points[3], points[0], color, 1);
+      if (mode == Mode::FILLED) {
+        screen::gfx::fill_polygon(std::data(prvpoints), std::size(prvpoints),
+                                  BLACK);
+        screen::gfx::fill_polygon(std::data(points), std::size(points), color);
+      } else if (mode == Mode::ANTI_ALIASED) {
+        /* the ramp is the color, so a new color is just a new ramp */
+        if (color != ramp_color) {
+          ramp_color = color;
+          static_cast<void>(screen::gfx::load_intensity_ramp(
+              std::data(palette), std::size(palette), RAMP_BASE, RAMP_LEVELS,
+              Demo_Palette[BLACK], Demo_Palette[color]));
+        }
+        /* erase everything first, or an erase would nick a corner just drawn
+         */
+        for (size_t ii = 0; ii < std::size(points); ++ii) {
+          screen::gfx::draw_line_aa(prvpoints[ii],
+                                    prvpoints[(ii + 1) % std::size(points)],
+                                    erase);
+        }
+        for (size_t ii = 0; ii < std::size(points); ++ii) {
+          screen::gfx::draw_line_aa(
+              points[ii], points[(ii + 1) % std::size(points)], ramp);
+        }
+      } else {
+        screen::gfx::draw_line(prvpoints[0], prvpoints[1], BLACK, 1);
+        screen::gfx::draw_line(points[0], points[1], color, 1);
+        screen::gfx::draw_line(prvpoints[1], prvpoints[2], BLACK, 1);
+        screen::gfx::draw_line(points[1], points[2], color, 1);
+        screen::gfx::draw_line(prvpoints[2], prvpoints[3], BLACK, 1);
+        screen::gfx::draw_line(points[2], points[3], color, 1);
+        screen::gfx::draw_line(prvpoints[3], prvpoints[0], BLACK, 1);
+        screen::gfx::draw_line(points[3], points[0], color, 1);
+      }
       prvpoints[0] = points[0];
       prvpoints[1] = points[1];
       prvpoints[2] = points[2];
@@ -283,6 +328,13 @@ void run_linebounce_screensaver() noexcept {
       if (state.etc) {
         break;
       }
+      if (state.up && !prev_up) {
+        mode = mode == Mode::OUTLINE  ? Mode::FILLED
+               : mode == Mode::FILLED ? Mode::ANTI_ALIASED
+                                      : Mode::OUTLINE;
+        screen::fill_screen(BLACK | (BLACK << 4));
+      }
+      prev_up = state.up;
     }
   }
 }
@@ -298,12 +350,14 @@ void run_text_animation() noexcept {
   while (true) {
     // run an animation, by hand
     printf("C:\\> ");
+    stdio_flush();
     // sleep_ms(500);
     sleep_ms(100);
     static constexpr std::string_view the_stuff{
         R"(This is a story all about how my life got switched turned upside down so take a minute just sit right there while I tell you howibecametheprince of a town called BelAir.)"};
     for (const auto c : the_stuff) {
       printf("%c", c);
+      stdio_flush();
       sleep_ms(10);
     }
     // sleep_ms(500);
@@ -325,71 +379,24 @@ void initialize_cool_touch_demo() noexcept {
   screen::clear_screen();
   screen::set_format(screen::Format::RGB565_LUT4);
   screen::init_clut(std::data(Demo_Palette), std::size(Demo_Palette));
+  /* touches land on any column, so pre-shift what we draw there */
+  screen::cache_tile(red);
+  screen::cache_tile(emerald);
   fill_routine(emerald);
   sleep_ms(1000000);
 }
 
+/* reports are pixels on the panel already; a smaller virtual screen sits in
+ * the middle of it, so move them onto that and keep them there */
 [[nodiscard]] screen::TouchReport
-to_pixelspace(screen::TouchReport rawloc) noexcept {
-  /*
-   * Screen is 320 columns and 240 rows
-   * Translation for our rotated text console is:
-   *  bottom row is x~=250
-   *  top row is x~=3600
-   *  left col is y~=350
-   *  right col is y~=3850
-   * For the native pixel display (i.e. our tiler):
-   *  col 0 is x~=250
-   *  col 239 is x~=3600
-   *  row 0 is y~=350
-   *  row 319 is y~=3850
-   *
-   * need to solve the linear system:
-   *  y = mx + b
-   * for both row and col:
-   *  col = m_col * rawloc.x + b_col
-   *  row = m_row * rawloc.y + b_row
-   *
-   * for col:
-   * |  0  |   | 250   1  |   | m_col |
-   * | 239 | = | 3600  1  | * | b_col |
-   * for row:
-   * |  0  |   | 350   1  |   | m_row |
-   * | 319 | = | 3850  1  | * | b_row |
-   *
-   * using octave-cli ( via A\b ), yields:
-   *  m_col = 0.071343
-   *  b_col = -17.836
-   *  m_row = 0.091143
-   *  b_row = -31.9
-   * we don't have a floating point unit, so fixed
-   * point it is!
-   */
-  constexpr int32_t M_COL_S_24_8{18};
-  constexpr int32_t B_COL_S_24_8{-4548};
-
-  constexpr int32_t M_ROW_S_24_8{23};
-  constexpr int32_t B_ROW_S_24_8{-8166};
-
-  auto &&zclamp{[](int16_t val, int16_t hi) -> int16_t {
-    if (val < 0) {
-      return 0;
-    }
-    if (val > hi) {
-      return hi;
-    }
-    return val;
-  }};
-
-  const auto raw_x{
-      (M_COL_S_24_8 * static_cast<int32_t>(rawloc.x) + B_COL_S_24_8) >> 8};
-  const auto raw_y{
-      (M_ROW_S_24_8 * static_cast<int32_t>(rawloc.y) + B_ROW_S_24_8) >> 8};
-
+to_pixelspace(screen::TouchReport loc) noexcept {
   const auto dims{screen::get_virtual_screen_size()};
-  return screen::TouchReport{.x = zclamp(raw_x, dims.width - 1),
-                             .y = zclamp(raw_y, dims.height - 1),
-                             .pen_up = rawloc.pen_up};
+  const auto phys{screen::get_physical_screen_size()};
+  loc.x -= static_cast<int>(phys.width - dims.width) / 2;
+  loc.y -= static_cast<int>(phys.height - dims.height) / 2;
+  loc.x = std::clamp(loc.x, 0, static_cast<int>(dims.width) - 1);
+  loc.y = std::clamp(loc.y, 0, static_cast<int>(dims.height) - 1);
+  return loc;
 }
 
 void undo_cool_touch_action(screen::TouchReport touch_loc) noexcept {
@@ -397,22 +404,19 @@ void undo_cool_touch_action(screen::TouchReport touch_loc) noexcept {
     return;
   }
   touch_loc = to_pixelspace(touch_loc);
-  const auto dims{screen::get_virtual_screen_size()};
-  screen::draw_tile(dims.width - touch_loc.x - 1, dims.height - touch_loc.y - 1,
-                    emerald);
+  screen::draw_tile(touch_loc.x, touch_loc.y, emerald);
 }
 
 void take_cool_touch_action(screen::TouchReport touch_loc) noexcept {
   touch_loc = to_pixelspace(touch_loc);
-  const auto dims{screen::get_virtual_screen_size()};
-  screen::draw_tile(dims.width - touch_loc.x - 1, dims.height - touch_loc.y - 1,
-                    red);
+  screen::draw_tile(touch_loc.x, touch_loc.y, red);
 }
 
 } // namespace
 
-static constexpr int64_t DOUBLE_TAP_PERIOD_THRESHOLD_US{550 *
-                                                        1000}; /* 100 ms? */
+static constexpr uint32_t DOUBLE_TAP_PERIOD_THRESHOLD_US{550 *
+                                                         1000}; /* 100 ms? */
+static constexpr size_t TOUCH_DEMO_REPORTS_PER_PASS{16};
 void run_touch_demo(TouchConfig cfg) noexcept {
   /* sample about every 10 ms?
    * we should really setup a timer for this... */
@@ -422,46 +426,63 @@ void run_touch_demo(TouchConfig cfg) noexcept {
   initialize_cool_touch_demo();
 
   // screen::TouchReport touch_to_undo{.x = -1};
-  absolute_time_t time_since_last_pen_up{0};
+  uint32_t time_since_last_pen_up{0};
+  bool have_last_pen_up{false};
   screen::TouchReport touch_since_last_pen_up{};
-  screen::TouchReport touch;
   screen::TouchReport prv_touch;
   TouchMachine state{TouchMachine::WAIT};
-  while (true) {
+
+  /* one report through the machine; it's timed by the report, not by when
+   * we got round to it */
+  auto &&step{[&](const screen::TouchReport &touch) {
     switch (state) {
     case TouchMachine::WAIT:
-      if (screen::get_touch_report(touch) && !touch.pen_up) {
+      if (!touch.pen_up) {
         state = TouchMachine::PEN_DOWN;
         prv_touch = touch;
       }
       break;
     case TouchMachine::PEN_DOWN:
-      if (screen::get_touch_report(touch)) {
-        if (touch.pen_up) {
-          state = TouchMachine::PEN_UP;
-        } else {
-          prv_touch = touch;
-          take_cool_touch_action(prv_touch);
-        }
-      }
-      break;
-    case TouchMachine::PEN_UP:
-      const auto now{get_absolute_time()};
-      const auto timediff{absolute_time_diff_us(time_since_last_pen_up, now)};
-      if (timediff < DOUBLE_TAP_PERIOD_THRESHOLD_US &&
-          // timediff > DOUBLE_TAP_PERIOD_THRESHOLD_US / 2 &&
-          std::abs(touch_since_last_pen_up.x - prv_touch.x) < 30 &&
-          std::abs(touch_since_last_pen_up.y - prv_touch.y) < 30) {
-        fill_routine(emerald);
+      if (touch.pen_up) {
+        state = TouchMachine::PEN_UP;
       } else {
-        // undo_cool_touch_action(touch_to_undo);
+        prv_touch = touch;
         take_cool_touch_action(prv_touch);
       }
-      time_since_last_pen_up = now;
-      touch_since_last_pen_up = prv_touch;
-      state = TouchMachine::WAIT;
-      // touch_to_undo = prv_touch;
+      break;
+    case TouchMachine::PEN_UP:
+      break;
+    }
+    if (state != TouchMachine::PEN_UP) {
+      return;
+    }
+    const auto timediff{touch.timestamp_us - time_since_last_pen_up};
+    if (have_last_pen_up && timediff < DOUBLE_TAP_PERIOD_THRESHOLD_US &&
+        // timediff > DOUBLE_TAP_PERIOD_THRESHOLD_US / 2 &&
+        std::abs(touch_since_last_pen_up.x - prv_touch.x) < 3 &&
+        std::abs(touch_since_last_pen_up.y - prv_touch.y) < 3) {
+      fill_routine(emerald);
+    } else {
+      // undo_cool_touch_action(touch_to_undo);
+      take_cool_touch_action(prv_touch);
     }
+    time_since_last_pen_up = touch.timestamp_us;
+    have_last_pen_up = true;
+    touch_since_last_pen_up = prv_touch;
+    state = TouchMachine::WAIT;
+    // touch_to_undo = prv_touch;
+  }};
+
+  std::array<screen::TouchReport, TOUCH_DEMO_REPORTS_PER_PASS> touches;
+  while (true) {
+    /* everything queued since the last pass, so we keep up with the pen */
+    uint32_t count;
+    do {
+      count = screen::get_touch_reports(std::data(touches), std::size(touches));
+      for (uint32_t idx = 0; idx < count; ++idx) {
+        step(touches[idx]);
+      }
+    } while (count == std::size(touches));
     sleep_ms(TOUCH_POLL_INTERVAL_MS);
   }
 }
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <limits>
 #include <string>
+#include <utility>
 
 #include "pico/multicore.h"
 #include "pico/printf.h"
@@ -12,7 +13,11 @@
 #include "ShellCmd_Menu.hpp"
 #include "bsio.hpp"
 #include "demo.hpp"
+#include "gamepad/debounce.hpp"
+#include "gamepad/touch_pad.hpp"
+#include "screen/gfx/shapes.hpp"
 #include "screen/screen.hpp"
+#include "screen/touch_gestures.hpp"
 #include "snake/snake.hpp"
 #include "status_utilities.hpp"
 
@@ -23,6 +28,77 @@ int mywrap_flush(FILE *) {
 }
 int mywrap_getchar(FILE *) { return stdio_getchar(); }
 
+/* Three crosses, each pressed and held a moment; the samples under each are
+ * averaged, then fit.  Any key gives up, keeping the calibration there was. */
+[[nodiscard]] static bool run_touch_calibration() {
+  namespace tc = screen::touch_calibration;
+  /* spread out, and not in a line, so small errors stay small */
+  static constexpr std::array<screen::gfx::Point, 3> TARGETS{
+      {{.x = 24, .y = 32}, {.x = 216, .y = 160}, {.x = 120, .y = 288}}};
+  static constexpr uint32_t ARM{8};
+  static constexpr uint32_t MIN_SAMPLES{8};
+
+  auto &&draw_cross{[](screen::gfx::Point at, uint32_t value) {
+    screen::gfx::draw_line({.x = at.x - ARM, .y = at.y},
+                           {.x = at.x + ARM + 1, .y = at.y}, value, 1);
+    screen::gfx::draw_line({.x = at.x, .y = at.y - ARM},
+                           {.x = at.x, .y = at.y + ARM + 1}, value, 1);
+  }};
+
+  /* the targets are on the upright glass, which calibrations are made for */
+  const auto orientation{screen::get_orientation()};
+  const bool mirrored{screen::get_mirrored()};
+  screen::set_orientation(screen::Orientation::PORTRAIT, false);
+  screen::clear_screen();
+  screen::set_touch_raw(true);
+
+  tc::Point pts[3];
+  bool aborted{false};
+  for (size_t idx = 0; idx < std::size(TARGETS) && !aborted; ++idx) {
+    draw_cross(TARGETS[idx], 1);
+    screen::TouchReport report;
+    while (screen::get_touch_report(report)) {
+      /* anything from before this cross went up */
+    }
+    int32_t sum_x{0};
+    int32_t sum_y{0};
+    uint32_t count{0};
+    while (!aborted) {
+      if (EOF != stdio_getchar()) {
+        aborted = true;
+      } else if (!screen::get_touch_report(report)) {
+        sleep_ms(1);
+      } else if (!report.pen_up) {
+        sum_x += report.x;
+        sum_y += report.y;
+        ++count;
+      } else if (count >= MIN_SAMPLES) {
+        break;
+      } else {
+        /* a brush, not a press */
+        sum_x = sum_y = count = 0;
+      }
+    }
+    draw_cross(TARGETS[idx], 0);
+    if (count > 0) {
+      pts[idx] = {.raw_x = sum_x / static_cast<int32_t>(count),
+                  .raw_y = sum_y / static_cast<int32_t>(count),
+                  .x = static_cast<int32_t>(TARGETS[idx].x),
+                  .y = static_cast<int32_t>(TARGETS[idx].y)};
+    }
+  }
+
+  screen::set_touch_raw(false);
+  screen::set_orientation(orientation, mirrored);
+
+  screen::TouchCalibration cal;
+  if (aborted || !tc::fit(pts, cal)) {
+    return false;
+  }
+  screen::set_touch_calibration(cal);
+  return true;
+}
+
 static void shellcmd_screen_usage(const auto &cmd) {
   /* clang-format off */
       // printf("  %s [format | size | buflen | clear | fill | calibrate | touch]\n\n", cmd);
@@ -31,9 +107,23 @@ screen format [ FORMAT ]
   Prints the screen's current BPP format specifier.
   Can be one of 
     {GREY1, GREY2, GREY4, 
-     RGB565_LUT8, RGB565}
+     RGB565_LUT2, RGB565_LUT4, RGB565_LUT8, RGB565}
   If FORMAT is given, sets the screen's BPP format.
-  Valid arguments are {1, 2, 4, 8, 16}
+  Valid arguments are {1, 2, 4, 8, 16}, and
+  RGB565_LUT2 or RGB565_LUT4 by name
+
+screen timing
+  Prints how long, in microseconds, the last format
+  or size change took, next to what powering the
+  panel up costs, and how much of the first power
+  up went on clearing the panel
+
+screen orientation [ DEGREES [ mirror ] ]
+  Prints how far the picture is turned on the glass.
+  If DEGREES is given, one of {0, 90, 180, 270},
+  turns it, and mirrors it left to right if
+  "mirror" follows.  90 and 270 swap the width
+  and height; the console only works at 0 and 180.
 
 screen size
   Prints the width and height of the dispaly, in 
@@ -48,10 +138,16 @@ screen clear
 screen fill VALUE
   Fills the video buffer with the raw value VALUE
 
-screen calibrate
-  Runs a touch-screen calibration routine.
-  Objective is to map touch samples values to pixel
-  position on the screen.
+screen calibrate [ reset ]
+  Runs a touch-screen calibration routine: press
+  and hold each of three crosses in turn, any key
+  gives up.  The result is kept in flash.
+  With "reset", goes back to the built in
+  calibration instead.
+
+screen gestures
+  Prints taps, long presses, drags and swipes as
+  they happen, until any key.
 
 screen touch [ ZTHRESH FIRST_TOSS LAST_TOSS ]
   Prints the current touch configuration.
@@ -82,7 +178,7 @@ int ShellCmd_Screen(int argc, const char *argv[]) {
   /* other commands */
   if (argc > 1) {
     if (!strcmp("clear", argv[1])) {
-      screen::clear_console();
+      bsio::clear();
     }
     if (!strcmp("buflen", argv[1])) {
       printf("%d\n", screen::get_buf_len());
@@ -100,6 +196,12 @@ int ShellCmd_Screen(int argc, const char *argv[]) {
         case screen::Format::GREY4:
           printf("GREY4\n");
           break;
+        case screen::Format::RGB565_LUT2:
+          printf("RGB565_LUT2\n");
+          break;
+        case screen::Format::RGB565_LUT4:
+          printf("RGB565_LUT4\n");
+          break;
         case screen::Format::RGB565_LUT8:
           printf("RGB565_LUT8\n");
           break;
@@ -107,6 +209,10 @@ int ShellCmd_Screen(int argc, const char *argv[]) {
           printf("RGB565\n");
           break;
         }
+      } else if (!strcmp("RGB565_LUT2", argv[2])) {
+        screen::set_format(screen::Format::RGB565_LUT2);
+      } else if (!strcmp("RGB565_LUT4", argv[2])) {
+        screen::set_format(screen::Format::RGB565_LUT4);
       } else {
         const auto bpp{std::stoi(argv[2])};
         switch (bpp) {
@@ -130,12 +236,97 @@ int ShellCmd_Screen(int argc, const char *argv[]) {
         }
       }
     }
+    if (!strcmp("timing", argv[1])) {
+      const auto stats{screen::get_mode_switch_stats()};
+      printf("  POWER_UP { %lu us }\n  BLANK { %lu us }\n"
+             "  SWITCH { %lu us }\n"
+             "  SWITCHES { %lu }\n  COLMOD_WRITES { %lu }\n",
+             static_cast<unsigned long>(stats.power_up_us),
+             static_cast<unsigned long>(stats.blank_us),
+             static_cast<unsigned long>(stats.switch_us),
+             static_cast<unsigned long>(stats.switches),
+             static_cast<unsigned long>(stats.colmod_writes));
+    }
+    if (!strcmp("orientation", argv[1])) {
+      static constexpr std::array<std::pair<int, screen::Orientation>, 4>
+          turns{{{0, screen::Orientation::PORTRAIT},
+                 {90, screen::Orientation::LANDSCAPE},
+                 {180, screen::Orientation::PORTRAIT_FLIPPED},
+                 {270, screen::Orientation::LANDSCAPE_FLIPPED}}};
+      if (argc == 2) {
+        const auto now{screen::get_orientation()};
+        for (const auto &[degrees, orientation] : turns) {
+          if (orientation == now) {
+            printf("%d%s\n", degrees,
+                   screen::get_mirrored() ? " mirror" : "");
+          }
+        }
+      } else {
+        const auto degrees{std::stoi(argv[2])};
+        const bool mirrored{argc > 3 && !strcmp("mirror", argv[3])};
+        const auto *turn{std::find_if(
+            std::begin(turns), std::end(turns),
+            [degrees](const auto &entry) { return entry.first == degrees; })};
+        if (turn == std::end(turns)) {
+          printf("Orientation %d unsupported\n", degrees);
+        } else if (!screen::set_orientation(turn->second, mirrored)) {
+          printf("The console only draws upright; %d is for apps\n",
+                 degrees);
+        }
+      }
+    }
     if (!strcmp("size", argv[1])) {
       const auto dims{screen::get_virtual_screen_size()};
       printf("%dx%d\n", dims.width, dims.height);
     }
     if (!strcmp("calibrate", argv[1])) {
-      printf("STUB: run touch screen calibration routine\n");
+      if (argc > 2 && !strcmp("reset", argv[2])) {
+        screen::set_touch_calibration(screen::touch_calibration::DEFAULT);
+      } else {
+        const bool fitted{run_touch_calibration()};
+        if (!screen::set_console_mode()) {
+          return -1;
+        }
+        if (!fitted) {
+          printf("Calibration abandoned, kept the old one\n");
+          return 0;
+        }
+      }
+      const auto cal{screen::get_touch_calibration()};
+      printf("  X { (%ld * raw_x + %ld * raw_y + %ld) / 65536 }\n"
+             "  Y { (%ld * raw_x + %ld * raw_y + %ld) / 65536 }\n",
+             static_cast<long>(cal.xx), static_cast<long>(cal.xy),
+             static_cast<long>(cal.x0), static_cast<long>(cal.yx),
+             static_cast<long>(cal.yy), static_cast<long>(cal.y0));
+      if (!screen::save_touch_calibration()) {
+        printf("Could not save the calibration to flash\n");
+      }
+    }
+
+    if (!strcmp("gestures", argv[1])) {
+      static constexpr std::array<const char *, 7> kinds{
+          "", "TAP", "LONG_PRESS", "DRAG_START", "DRAG", "DRAG_END", "SWIPE"};
+      static constexpr std::array<const char *, 4> directions{"UP", "DOWN",
+                                                              "LEFT", "RIGHT"};
+      screen::gestures::Recognizer recognizer;
+      screen::TouchReport report;
+      while (EOF == stdio_getchar()) {
+        if (!screen::get_touch_report(report)) {
+          sleep_ms(1);
+          continue;
+        }
+        const auto gesture{recognizer.feed(report)};
+        if (gesture.kind == screen::gestures::Kind::NONE) {
+          continue;
+        }
+        printf("%s { %d, %d } { %+d, %+d } %lu ms %s\n",
+               kinds[static_cast<size_t>(gesture.kind)], gesture.x, gesture.y,
+               gesture.dx, gesture.dy,
+               static_cast<unsigned long>(gesture.held_us / 1000),
+               gesture.kind == screen::gestures::Kind::SWIPE
+                   ? directions[static_cast<size_t>(gesture.direction)]
+                   : "");
+      }
     }
 
     if (!strcmp("touch", argv[1])) {
@@ -145,6 +336,8 @@ int ShellCmd_Screen(int argc, const char *argv[]) {
         dispGetTouchConfiguration(&cfg);
         printf("  ZTHRESH { %d }\n  FIRST_TOSS { %d }\n  LAST_TOSS { %d }\n",
                cfg.touch_zthresh, cfg.first_toss, cfg.last_toss);
+        printf("  DROPPED { %u }\n",
+               static_cast<unsigned>(screen::get_touch_reports_dropped()));
       }
       if (argc == 5) /* requesting a change */
       {
@@ -213,7 +406,178 @@ int ShellCmd_Demo(int argc, const char *argv[]) {
 }
 
 static int ShellCmd_Clear(int, const char *[]) {
-  screen::clear_console();
+  bsio::clear();
+  return 0;
+}
+
+static int ShellCmd_Scrollback(int argc, const char *argv[]) {
+  if (argc > 1) {
+    printf("%s\n  k/j: up/down a line\n  u/d: up/down half a screen\n"
+           "  q: back to the prompt\n",
+           argv[0]);
+    return 0;
+  }
+  const auto depth{bsio::scrollback_depth()};
+  const auto half_page{screen::get_console_width_and_height().height / 2};
+  uint32_t offset{0};
+  for (;;) {
+    const int c{stdio_getchar()};
+    if (c == EOF) {
+      continue;
+    }
+    if (c == 'k') {
+      offset = std::min(offset + 1, depth);
+    } else if (c == 'j') {
+      offset = offset > 0 ? offset - 1 : 0;
+    } else if (c == 'u') {
+      offset = std::min(offset + half_page, depth);
+    } else if (c == 'd') {
+      offset = offset > half_page ? offset - half_page : 0;
+    } else if (c == 'q') {
+      break;
+    }
+    bsio::view_scrollback(offset);
+  }
+  bsio::view_scrollback(0);
+  return 0;
+}
+
+/* RAM to RAM copying, as fast as core 0 can go, for duration_us */
+[[nodiscard]] static uint64_t bench_copy_bytes(uint32_t duration_us) {
+  static std::array<uint32_t, 2048> src;
+  static std::array<uint32_t, 2048> dst;
+  uint64_t copied{0};
+  const auto start{time_us_32()};
+  while (time_us_32() - start < duration_us) {
+    std::copy(std::begin(src), std::end(src), std::begin(dst));
+    asm volatile("" ::: "memory"); /* keep the copy */
+    copied += sizeof(src);
+  }
+  return copied;
+}
+
+static int ShellCmd_Bench(int argc, const char *argv[]) {
+  if (argc > 1) {
+    printf("%s\n  RAM copy speed with the screen streaming, then with\n"
+           "  the screen on demand and idle\n",
+           argv[0]);
+    return 0;
+  }
+  static constexpr uint32_t DURATION_US{500'000};
+  const auto mode{screen::get_refresh_mode()};
+  screen::set_refresh_mode(screen::RefreshMode::CONTINUOUS);
+  const auto streaming{bench_copy_bytes(DURATION_US)};
+  screen::set_refresh_mode(screen::RefreshMode::ON_DEMAND);
+  const auto idle{bench_copy_bytes(DURATION_US)};
+  screen::set_refresh_mode(mode);
+
+  const auto kb_per_s{[](uint64_t bytes) {
+    return static_cast<unsigned long>(bytes * 1'000'000 / DURATION_US / 1024);
+  }};
+  printf("streaming : %lu KB/s\nidle      : %lu KB/s\n", kb_per_s(streaming),
+         kb_per_s(idle));
+  return 0;
+}
+
+static int ShellCmd_TouchPad(int argc, const char *argv[]) {
+  /* laid out for the panel as it is when turned on */
+  static gamepad::five::TouchPad pad;
+  if (argc == 2 && !strcmp("on", argv[1])) {
+    pad = gamepad::five::TouchPad::dpad(screen::get_physical_screen_size());
+    gamepad::five::set_touch_pad(&pad);
+  } else if (argc == 2 && !strcmp("off", argv[1])) {
+    gamepad::five::set_touch_pad(nullptr);
+  } else if (argc == 1) {
+    printf("%s\n", gamepad::five::get_touch_pad() ? "on" : "off");
+  } else {
+    printf("%s [on | off]\n  Play with the touch screen as a gamepad: top "
+           "third up, bottom third\n  down, middle left, etc and right.\n",
+           argv[0]);
+  }
+  return 0;
+}
+
+static int ShellCmd_Gamepad(int argc, const char *argv[]) {
+  if (argc == 3 && !strcmp("poll", argv[1])) {
+    const auto asked{static_cast<uint32_t>(std::stoi(argv[2]))};
+    printf("poll every %lu us\n", static_cast<unsigned long>(
+                                       gamepad::five::set_poll_interval_us(
+                                           asked)));
+  } else if (argc == 1) {
+    const auto stats{gamepad::five::get_debounce_stats()};
+    printf("poll every %lu us, debounced over four\n"
+           "  polls    : %lu\n"
+           "  accepted : %lu\n"
+           "  rejected : %lu\n"
+           "  dropped  : %lu events\n",
+           static_cast<unsigned long>(gamepad::five::get_poll_interval_us()),
+           static_cast<unsigned long>(stats.polls),
+           static_cast<unsigned long>(stats.accepted),
+           static_cast<unsigned long>(stats.rejected),
+           static_cast<unsigned long>(gamepad::five::get_events_dropped()));
+  } else {
+    printf("%s [poll <us>]\n  Button debounce counts: transitions accepted, "
+           "and bounces\n  rejected.  poll sets how often the buttons are "
+           "sampled.\n",
+           argv[0]);
+  }
+  return 0;
+}
+
+static int ShellCmd_Boot(int argc, const char *argv[]) {
+  if (argc > 1) {
+    printf("%s\n  when each boot phase was reached, from reset\n", argv[0]);
+    return 0;
+  }
+  static constexpr std::array<std::pair<bsio::BootPhase, const char *>, 4>
+      phases{{{bsio::BootPhase::SCREEN_INIT, "screen init  "},
+              {bsio::BootPhase::SCREEN_READY, "screen ready "},
+              {bsio::BootPhase::CONSOLE_READY, "console ready"},
+              {bsio::BootPhase::MENU, "menu         "}}};
+  uint64_t prev_us{0};
+  for (const auto &[phase, label] : phases) {
+    const auto when_us{bsio::boot_phase_us(phase)};
+    if (when_us == 0) {
+      printf("%s : not reached\n", label);
+      continue;
+    }
+    printf("%s : %6lu us  (+%lu us)\n", label,
+           static_cast<unsigned long>(when_us),
+           static_cast<unsigned long>(when_us - prev_us));
+    prev_us = when_us;
+  }
+  return 0;
+}
+
+static int ShellCmd_Stats(int argc, const char *argv[]) {
+  if (argc > 1) {
+    printf("%s\n  live uptime and console readout, any key to stop\n",
+           argv[0]);
+    return 0;
+  }
+  /* draw the labels once, then only rewrite the values in place */
+  printf("\x1b[?25l"
+         "uptime     :\n"
+         "scrollback :\n"
+         "refreshes  :\n");
+  uint32_t refreshes{0};
+  for (;;) {
+    const auto uptime_ms{static_cast<uint32_t>(time_us_64() / 1000)};
+    printf("\x1b[s"
+           "\x1b[3A\x1b[13C\x1b[7m%lu.%03lu s\x1b[0m\x1b[K"
+           "\x1b[1B\r\x1b[13C%lu lines\x1b[K"
+           "\x1b[1B\r\x1b[13C%lu\x1b[K"
+           "\x1b[u",
+           static_cast<unsigned long>(uptime_ms / 1000),
+           static_cast<unsigned long>(uptime_ms % 1000),
+           static_cast<unsigned long>(bsio::scrollback_depth()),
+           static_cast<unsigned long>(++refreshes));
+    stdio_flush();
+    if (getchar_timeout_us(100'000) != PICO_ERROR_TIMEOUT) {
+      break;
+    }
+  }
+  printf("\x1b[?25h");
   return 0;
 }
 
@@ -230,10 +594,16 @@ int main() {
 
   {
     ShellFunction_t additional_cmds[] = {
+        {.id = "bench", .callback = ShellCmd_Bench},
+        {.id = "boot", .callback = ShellCmd_Boot},
         {.id = "clear", .callback = ShellCmd_Clear},
         {.id = "demo", .callback = ShellCmd_Demo},
+        {.id = "gamepad", .callback = ShellCmd_Gamepad},
         {.id = "screen", .callback = ShellCmd_Screen},
+        {.id = "scrollback", .callback = ShellCmd_Scrollback},
         {.id = "snake", .callback = ShellCmd_Snake},
+        {.id = "stats", .callback = ShellCmd_Stats},
+        {.id = "touchpad", .callback = ShellCmd_TouchPad},
         {.id = "menu", .callback = ShellCmd_Menu},
     };
     const int ADDITIONAL_CMDS_LENGTH =
@@ -9,6 +9,7 @@
 #include "revenge_tiles.hpp"
 
 #include "common/BitImage.hpp"
+#include "common/GlyphCache.hpp"
 #include "common/screen_utils.hpp"
 #include "embp/circular_array.hpp"
 #include "gamepad/gamepad.hpp"
@@ -849,18 +850,15 @@ void draw_score(uint32_t score) {
   /* convert integral score into 6 decimal digits */
   const auto digits{screen::bcd<6>(score)};
 
-  /* tile and buffer to hold the 4bpp version of the character set */
-  screen::letter_4bpp_array_t letter_4bpp_data{};
-  const screen::Tile letter_tile{.side_length = glyphs::tile::width(),
-                                 .format = screen::Format::RGB565_LUT4,
-                                 .data = std::data(letter_4bpp_data)};
+  /* one color pair, ten digits */
+  static GlyphCache<10> digit_cache;
 
   const auto row_start{g_top_panel.score_start.y};
   auto col_start{g_top_panel.score_start.x};
   for (const auto digit : digits) {
-    const auto tile_1bpp{
-        glyphs::tile::decode_ascii(static_cast<char>(digit + 0x30))};
-    copy_1bpptile_to_4bpp_buffer(letter_4bpp_data, tile_1bpp, BLACK, LGREY);
+    const auto letter_tile{digit_cache.get(static_cast<char>(digit + 0x30),
+                                           BLACK, LGREY,
+                                           screen::Format::RGB565_LUT4)};
     screen::draw_tile(col_start, row_start, letter_tile);
     col_start += letter_tile.side_length;
   }
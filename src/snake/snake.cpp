@@ -15,6 +15,7 @@
 #endif
 
 #include "screen/TileDef.h"
+#include "screen/glyphs/font.hpp"
 #include "screen/glyphs/letters.hpp"
 #include "screen/screen.hpp"
 
@@ -22,6 +23,7 @@
 
 #include "embp/circular_array.hpp"
 
+#include "common/GlyphCache.hpp"
 #include "common/screen_utils.hpp"
 #include "snake_common.hpp"
 #include "snake_levels_constexpr.hpp"
@@ -123,27 +125,6 @@ void draw_grid_tile(grid_t x, grid_t y, const screen::Tile &tile) {
   screen::draw_tile(pixx, pixy, tile);
 }
 
-/** @brief convert 1bpp letter tile into double-sized, 4bpp versions
- */
-template <size_t N>
-constexpr void copy_tile_to_4bpp_buffer_and_double_in_size(
-    std::array<uint8_t, N> &tile_4bpp, const screen::Tile &tile_1bpp) noexcept {
-  const auto *p_in{tile_1bpp.data};
-  auto *p_out{std::data(tile_4bpp)};
-
-  for (uint32_t yy = 0; yy < glyphs::tile::height() * 2; ++yy) {
-    auto inrow{p_in[yy >> 1]};
-    for (uint32_t xx = 0; xx < glyphs::tile::width() * 2; xx += 2) {
-      const uint32_t outpixloc{yy * glyphs::tile::width() * 2 + xx};
-      auto &out{p_out[outpixloc >> 1]};
-
-      out = inrow & 0b1 ? snake::WHITE << 4 | snake::WHITE
-                        : snake::BLACK << 4 | snake::BLACK;
-      inrow >>= 1;
-    }
-  }
-}
-
 /** @brief Advances a Grid::Location in a given Direction
  *
  * @param point Grid Point
@@ -1327,19 +1308,16 @@ void draw_score() {
   /* convert integral score into 6 decimal digits */
   const auto digits{screen::bcd<6>(g_score)};
 
-  /* convert the existing 1bpp number glyphs into double-sized 4bpp versions */
-  std::array<uint8_t, 4 * 4 * glyphs::tile::height()> letter_4bpp_data{};
-  const screen::Tile letter_tile{.side_length = glyphs::tile::width() * 2,
-                                 .format = screen::Format::RGB565_LUT4,
-                                 .data = std::data(letter_4bpp_data)};
+  /* double-sized 4bpp versions of the 1bpp number glyphs */
+  static GlyphCache<10, 2> digit_cache;
 
   /* go from msd to lsd */
   const auto row_start{g_top_panel_cfg.row_start_score};
   auto col_start{g_top_panel_cfg.col_start_score};
   for (const auto digit : digits) {
-    const auto tile_1bpp{
-        glyphs::tile::decode_ascii(static_cast<char>(digit + 0x30))};
-    copy_tile_to_4bpp_buffer_and_double_in_size(letter_4bpp_data, tile_1bpp);
+    const auto letter_tile{digit_cache.get(static_cast<char>(digit + 0x30),
+                                           snake::WHITE, snake::BLACK,
+                                           screen::Format::RGB565_LUT4, 2)};
     screen::draw_tile(col_start, row_start, letter_tile);
     col_start += letter_tile.side_length;
   }
@@ -1354,72 +1332,42 @@ void update_lives_based_on_score(int8_t &lives) noexcept {
 
 void draw_level_name(uint32_t level_number) {
 
-  screen::letter_4bpp_array_t buffer{};
-  const screen::Tile tile_obj{.side_length = glyphs::tile::width(),
-                              .format = screen::Format::RGB565_LUT4,
-                              .data = std::data(buffer)};
-
-  /* the word 'level' is 5*tile_obj.side_length pixels wide and tall
-   * if we want it centered in the display:
-   *  xpos = (display_width / 2) - 2.5*tile_obj.side_length
-   * for the level number itself, it depends on how many digits need to be
-   *
-   * displayed row-wise, there are two lines to display.  Let's center them, as
-   * well: space_between_lines = (gridscale*gridheight -
-   * 2*tile_obj.side_length)/3 ypos_line1 = gridoffsety + space_between_lines
-   *  ypos_line2 = gridoffsety + 2*space_between_lines + tile_obj.side_length
-   *
-   *
+  /* proportional glyphs at triple size, each line centered in the grid:
+   *  space_between_lines = (grid_pixel_height - 2*text_height) / 3
+   *  ypos_line1 = gridoffsety + space_between_lines
+   *  ypos_line2 = ypos_line1 + text_height + space_between_lines
    */
-  const auto dims{screen::get_virtual_screen_size()};
-
-  const uint32_t xpos_line1{(dims.width - 5 * tile_obj.side_length) >> 1};
+  static constexpr uint32_t TEXT_SCALE{3};
+  const auto font{glyphs::font::proportional()};
+  const uint32_t text_height{font.height * TEXT_SCALE};
 
   const auto gridscale{g_grid.config().ydimension.scale};
   const auto gridoffsety{g_grid.config().ydimension.off};
-  const auto gridoffsetx{g_grid.config().ydimension.off};
-  const auto gridheight{g_grid.config().grid_height};
-  const auto gridwidth{g_grid.config().grid_width};
+  const auto gridoffsetx{g_grid.config().xdimension.off};
+  const uint32_t grid_pixel_height{gridscale * g_grid.config().grid_height};
+  const uint32_t grid_pixel_width{gridscale * g_grid.config().grid_width};
 
-  const auto space_between_lines{
-      (gridscale * gridheight - 2 * tile_obj.side_length) / 3};
+  const auto space_between_lines{(grid_pixel_height - 2 * text_height) / 3};
   const auto ypos_line1{gridoffsety + space_between_lines};
-  const auto ypos_line2{gridoffsety + 2 * space_between_lines +
-                        tile_obj.side_length};
+  const auto ypos_line2{ypos_line1 + text_height + space_between_lines};
+
+  auto &&draw_centered{[&](const char *str, size_t len, uint32_t ypos) {
+    const uint32_t width{glyphs::font::text_width(font, str, len) *
+                         TEXT_SCALE};
+    const uint32_t xpos{gridoffsetx + (grid_pixel_width - width) / 2};
+    screen::draw_text(xpos, ypos, str, len, font, snake::WHITE, snake::BLACK,
+                      TEXT_SCALE);
+  }};
 
-  const auto space_between_cols_line_2{
-      (gridwidth * gridscale - 2 * tile_obj.side_length) / 3};
+  draw_centered("Level", 5, ypos_line1);
 
   const auto digits{screen::bcd<2>(level_number)};
-  const auto number_of_digits_to_draw{digits[0] != 0 ? 2 : 1};
-  const uint32_t xpos_incr{tile_obj.side_length + space_between_cols_line_2};
-  const uint32_t xpos_line2{
-      number_of_digits_to_draw == 1
-          ? (gridscale * gridwidth - tile_obj.side_length) >> 1
-          : space_between_cols_line_2};
-
-  /* draw the text "Level" */
-  {
-    uint32_t xpos{xpos_line1};
-    for (const char c : std::array{'L', 'e', 'v', 'e', 'l'}) {
-      screen::get_letter_data_4bpp(buffer, c, snake::WHITE, snake::BLACK);
-      screen::draw_tile(xpos, ypos_line1, tile_obj);
-      xpos += tile_obj.side_length;
-    }
-  }
-
-  /* draw the level number*/
-  {
-    uint32_t xpos{xpos_line2};
-    screen::get_letter_data_4bpp(buffer, static_cast<char>(digits[1] + 0x30),
-                                 snake::WHITE, snake::BLACK);
-    screen::draw_tile(xpos, ypos_line2, tile_obj);
-    if (number_of_digits_to_draw == 2) {
-      xpos += xpos_incr;
-      screen::get_letter_data_4bpp(buffer, static_cast<char>(digits[0] + 0x30),
-                                   snake::WHITE, snake::BLACK);
-      screen::draw_tile(xpos, ypos_line2, tile_obj);
-    }
+  const std::array<char, 2> number{static_cast<char>(digits[0] + 0x30),
+                                   static_cast<char>(digits[1] + 0x30)};
+  if (digits[0] != 0) {
+    draw_centered(std::data(number), 2, ypos_line2);
+  } else {
+    draw_centered(std::data(number) + 1, 1, ypos_line2);
   }
 }
 
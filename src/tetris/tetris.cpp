@@ -6,7 +6,9 @@
 #include "pico/time.h"
 
 #include "common/BitImage.hpp"
+#include "common/GlyphCache.hpp"
 #include "common/screen_utils.hpp"
+#include "gamepad/button_events.hpp"
 #include "gamepad/gamepad.hpp"
 
 // #define PRINT_DEBUG_MSG
@@ -121,6 +123,8 @@ static GuiCfg g_gui;
 static uint32_t g_lines_scored{};
 static absolute_time_t g_game_tick_us{INITIAL_GAME_TICK_US};
 static uint32_t g_points_scored{};
+/* the gui only ever shows digits and a few labels, in one color pair */
+static GlyphCache<24> g_glyph_cache;
 static constexpr std::array<uint32_t, 9> g_level_thresholds{10, 20, 30, 40, 50,
                                                             60, 70, 80, 90};
 static constexpr std::array<uint8_t, 10> g_level_color{
@@ -213,41 +217,28 @@ void scoring_gui_draw_rectangle_primitive(uint32_t topy, uint32_t leftx,
                                           uint8_t coloridx,
                                           uint32_t thickness) {
 
-  /* our stack allocated tile */
-  const screen::Tile tile{
-      .side_length = 1, .format = VIDEO_FORMAT, .data = &coloridx};
+  auto &&fill_rows{[&](uint32_t row_start, uint32_t row_finish) {
+    for (uint32_t yy = row_start; yy < row_finish; ++yy) {
+      screen::fillspan(coloridx, yy, leftx, rightx);
+    }
+  }};
+  auto &&fill_columns{[&](uint32_t column_start, uint32_t column_finish) {
+    for (uint32_t xx = column_start; xx < column_finish; ++xx) {
+      screen::fillcolumn(coloridx, xx, topy, boty);
+    }
+  }};
 
   if (thickness == 0) {
-    for (uint32_t yy = topy; yy < boty; ++yy) {
-      for (uint32_t xx = leftx; xx < rightx; ++xx) {
-        screen::draw_tile(xx, yy, tile);
-      }
-    }
+    fill_rows(topy, boty);
   } else {
     /* bot row */
-    for (uint32_t yy = boty - thickness; yy < boty; ++yy) {
-      for (uint32_t xx = leftx; xx < rightx; ++xx) {
-        screen::draw_tile(xx, yy, tile);
-      }
-    }
+    fill_rows(boty - thickness, boty);
     /* right column */
-    for (uint32_t yy = topy; yy < boty; ++yy) {
-      for (uint32_t xx = rightx - thickness; xx < rightx; ++xx) {
-        screen::draw_tile(xx, yy, tile);
-      }
-    }
+    fill_columns(rightx - thickness, rightx);
     /* top row */
-    for (uint32_t yy = topy; yy < topy + thickness; ++yy) {
-      for (uint32_t xx = leftx; xx < rightx; ++xx) {
-        screen::draw_tile(xx, yy, tile);
-      }
-    }
+    fill_rows(topy, topy + thickness);
     /* left column */
-    for (uint32_t yy = topy; yy < boty; ++yy) {
-      for (uint32_t xx = leftx; xx < leftx + thickness; ++xx) {
-        screen::draw_tile(xx, yy, tile);
-      }
-    }
+    fill_columns(leftx, leftx + thickness);
   }
 }
 /* ========================================================================== */
@@ -260,37 +251,40 @@ void scoring_gui_draw_rectangle_primitive(uint32_t topy, uint32_t leftx,
 /* ========================================================================== */
 enum struct UserInput { LEFT, RIGHT, UP, DOWN, QUIT, NONE, DROP };
 
+/* One action per call, the rest stay queued for the next tick.  Holding left
+ * or right keeps sliding; rotating and dropping take a press each. */
 [[nodiscard]] UserInput process_user_input() noexcept {
-  static bool waiting_for_release{false};
-
-  const gamepad::five::State state{gamepad::five::get()};
+  using gamepad::five::Button;
+  using gamepad::five::EventKind;
 
-  if (!waiting_for_release) {
-    if (state.up) {
-      waiting_for_release = true;
-      return UserInput::UP;
+  gamepad::five::Event event;
+  while (gamepad::five::get_event(event)) {
+    if (event.kind == EventKind::RELEASE) {
+      continue;
     }
-    if (state.down) {
-      waiting_for_release = true;
-      return UserInput::DOWN;
-    }
-    if (state.left) {
-      waiting_for_release = true;
+    const bool pressed{event.kind == EventKind::PRESS};
+    switch (event.button) {
+    case Button::LEFT:
       return UserInput::LEFT;
-    }
-    if (state.right) {
-      waiting_for_release = true;
+    case Button::RIGHT:
       return UserInput::RIGHT;
-    }
-    if (state.etc) {
-      return UserInput::QUIT;
+    case Button::UP:
+      if (pressed) {
+        return UserInput::UP;
+      }
+      break;
+    case Button::DOWN:
+      if (pressed) {
+        return UserInput::DOWN;
+      }
+      break;
+    case Button::ETC:
+      if (pressed) {
+        return UserInput::QUIT;
+      }
+      break;
     }
   }
-
-  if (!state.up && !state.down && !state.left && !state.right && !state.etc) {
-    waiting_for_release = false;
-  }
-
   return UserInput::NONE;
 }
 
@@ -599,12 +593,6 @@ void scoring_gui_draw_underlay() {
 void scoring_gui_write_text(const char *str, uint32_t yoffset) {
   /* all specified in pixel space */
 
-  /* temp buffer for bit-expanded characters */
-  screen::letter_4bpp_array_t buffer;
-  const screen::Tile tile{.side_length = glyphs::tile::width(),
-                          .format = VIDEO_FORMAT,
-                          .data = std::data(buffer)};
-
   /* "line score" underlay and text */
   const auto ypos{yoffset};
   auto xpos{g_gui.line_score_text.x};
@@ -613,9 +601,9 @@ void scoring_gui_write_text(const char *str, uint32_t yoffset) {
     if (str[idx] == '\0') {
       break;
     }
-    screen::get_letter_data_4bpp(buffer, str[idx], GUI_TEXT_COLOR,
-                                 GUI_UNDERLAY_COLOR_MAIN);
-    screen::draw_tile(xpos, ypos, tile);
+    screen::draw_tile(xpos, ypos,
+                      g_glyph_cache.get(str[idx], GUI_TEXT_COLOR,
+                                        GUI_UNDERLAY_COLOR_MAIN, VIDEO_FORMAT));
     xpos += glyphs::tile::width();
   }
 }
@@ -646,27 +634,22 @@ void init_gui() {
 }
 
 void scoring_gui_draw_bcd_number(const auto &digits, uint32_t yoffset) {
-  screen::letter_4bpp_array_t buffer;
-  const screen::Tile tile{.side_length = glyphs::tile::width(),
-                          .format = VIDEO_FORMAT,
-                          .data = std::data(buffer)};
+  auto &&digit_tile{[](uint8_t digit) {
+    return g_glyph_cache.get(static_cast<char>(digit + 0x30), GUI_TEXT_COLOR,
+                             GUI_UNDERLAY_COLOR_MAIN, VIDEO_FORMAT);
+  }};
 
   bool written{false};
   const auto ypos{yoffset};
   auto xpos{g_gui.line_score_text.x};
   for (uint32_t idx{0}; idx < std::size(digits) - 1; ++idx) {
     if (digits[idx] > 0 || written) {
-      screen::get_letter_data_4bpp(buffer,
-                                   static_cast<char>(digits[idx] + 0x30),
-                                   GUI_TEXT_COLOR, GUI_UNDERLAY_COLOR_MAIN);
-      screen::draw_tile(xpos, ypos, tile);
+      screen::draw_tile(xpos, ypos, digit_tile(digits[idx]));
       written = true;
     }
     xpos += glyphs::tile::width();
   }
-  screen::get_letter_data_4bpp(buffer, static_cast<char>(digits.back() + 0x30),
-                               GUI_TEXT_COLOR, GUI_UNDERLAY_COLOR_MAIN);
-  screen::draw_tile(xpos, ypos, tile);
+  screen::draw_tile(xpos, ypos, digit_tile(digits.back()));
 }
 
 void draw_level_score() noexcept {
@@ -1038,10 +1021,8 @@ void run() {
   draw_level_score();
 
   gamepad::five::init();
-
-  while (process_user_input() != UserInput::NONE) {
-    tight_loop_contents();
-  }
+  /* the press that started us isn't a move */
+  gamepad::five::flush_events();
 
   while (keep_going) {
     if (get_elapsed(process_clock) > PROCESS_TICK_US) {
@@ -0,0 +1,189 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "gamepad/button_events.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+using gamepad::five::Button;
+using gamepad::five::EdgeDetector;
+using gamepad::five::Event;
+using gamepad::five::EventKind;
+using gamepad::five::RepeatConfig;
+
+static constexpr uint32_t POLL_US{10'000};
+
+[[nodiscard]] constexpr uint32_t bit(Button button) {
+  return 1U << static_cast<uint32_t>(button);
+}
+
+/* Polls the detector every POLL_US with a held mask from trace, which gives
+ * the mask for each poll number. */
+template <class Trace>
+[[nodiscard]] std::vector<Event> run(EdgeDetector &det, uint32_t start_us,
+                                     uint32_t polls, Trace &&trace) {
+  std::vector<Event> out;
+  for (uint32_t poll = 0; poll < polls; ++poll) {
+    det.update(trace(poll), start_us + poll * POLL_US,
+               [&out](const Event &event) { out.push_back(event); });
+  }
+  return out;
+}
+
+[[nodiscard]] bool check(const char *name, bool ok) {
+  if (PRINT_DEBUG && !ok) {
+    std::cerr << "  " << name << " failed\n";
+  }
+  return ok;
+}
+
+[[nodiscard]] bool same(const Event &event, Button button, EventKind kind,
+                        uint32_t timestamp_us) {
+  return event.button == button && event.kind == kind &&
+         event.timestamp_us == timestamp_us;
+}
+
+[[nodiscard]] bool test_edges(uint32_t start_us) {
+  bool status{true};
+  /* repeat off, to see the edges alone */
+  EdgeDetector det{{.delay_us = 0, .interval_us = 0}};
+  det.reset(0, start_us);
+
+  /* a press on poll 3 held through poll 7, released on poll 8 */
+  const auto events{run(det, start_us, 20, [](uint32_t poll) {
+    return poll >= 3 && poll < 8 ? bit(Button::LEFT) : 0;
+  })};
+  status &= check("edges count", events.size() == 2);
+  status &= check("edges press",
+                  events.size() == 2 &&
+                      same(events[0], Button::LEFT, EventKind::PRESS,
+                           start_us + 3 * POLL_US) &&
+                      same(events[1], Button::LEFT, EventKind::RELEASE,
+                           start_us + 8 * POLL_US));
+
+  /* two at once, and one let go while the other stays */
+  const auto pair{run(det, start_us, 6, [](uint32_t poll) -> uint32_t {
+    if (poll == 1) {
+      return bit(Button::UP) | bit(Button::ETC);
+    }
+    return poll >= 2 && poll < 4 ? bit(Button::ETC) : 0;
+  })};
+  status &= check("pair",
+                  pair.size() == 4 &&
+                      same(pair[0], Button::UP, EventKind::PRESS,
+                           start_us + POLL_US) &&
+                      same(pair[1], Button::ETC, EventKind::PRESS,
+                           start_us + POLL_US) &&
+                      same(pair[2], Button::UP, EventKind::RELEASE,
+                           start_us + 2 * POLL_US) &&
+                      same(pair[3], Button::ETC, EventKind::RELEASE,
+                           start_us + 4 * POLL_US));
+  status &= check("held", det.held() == 0);
+  return status;
+}
+
+[[nodiscard]] bool test_reset(uint32_t start_us) {
+  bool status{true};
+  EdgeDetector det;
+
+  /* already down when we start: no press, but the release still comes */
+  det.reset(bit(Button::ETC), start_us);
+  const auto events{run(det, start_us, 10, [](uint32_t poll) {
+    return poll < 5 ? bit(Button::ETC) : 0;
+  })};
+  status &= check("reset", events.size() == 1 &&
+                               events[0].kind == EventKind::RELEASE &&
+                               events[0].button == Button::ETC);
+  return status;
+}
+
+[[nodiscard]] bool test_repeat(uint32_t start_us) {
+  bool status{true};
+  EdgeDetector det{{.delay_us = 300'000, .interval_us = 50'000}};
+  det.reset(0, start_us);
+
+  /* pressed on poll 0 and held for a second */
+  const auto events{run(det, start_us, 100, [](uint32_t poll) {
+    return poll < 100 ? bit(Button::RIGHT) : 0;
+  })};
+  status &= check("repeat press", !events.empty() &&
+                                      same(events[0], Button::RIGHT,
+                                           EventKind::PRESS, start_us));
+  /* first repeat after the delay, then every interval: 300, 350 ... 950 ms */
+  uint32_t expect_us{start_us + 300'000};
+  size_t repeats{0};
+  for (size_t idx = 1; idx < events.size(); ++idx) {
+    status &= check("repeat", same(events[idx], Button::RIGHT,
+                                   EventKind::REPEAT, expect_us));
+    expect_us += 50'000;
+    ++repeats;
+  }
+  status &= check("repeat count", repeats == 14);
+
+  /* let go stops it, and pressing again waits the whole delay again */
+  const auto again{run(det, start_us, 35, [](uint32_t poll) {
+    return poll == 0 ? 0 : bit(Button::RIGHT);
+  })};
+  status &= check("repeat again",
+                  again.size() == 3 && again[0].kind == EventKind::RELEASE &&
+                      again[1].kind == EventKind::PRESS &&
+                      same(again[2], Button::RIGHT, EventKind::REPEAT,
+                           start_us + 31 * POLL_US));
+  return status;
+}
+
+[[nodiscard]] bool test_late_poll(uint32_t start_us) {
+  bool status{true};
+  EdgeDetector det{{.delay_us = 100'000, .interval_us = 20'000}};
+  det.reset(0, start_us);
+  std::vector<Event> out;
+  auto &&collect{[&out](const Event &event) { out.push_back(event); }};
+
+  det.update(bit(Button::DOWN), start_us, collect);
+  /* the alarm was held off for half a second: one repeat, not 25 */
+  det.update(bit(Button::DOWN), start_us + 500'000, collect);
+  status &= check("late", out.size() == 2 &&
+                              out[1].kind == EventKind::REPEAT);
+  /* and the next one an interval on from there */
+  det.update(bit(Button::DOWN), start_us + 510'000, collect);
+  det.update(bit(Button::DOWN), start_us + 520'000, collect);
+  status &= check("late next",
+                  out.size() == 3 && out[2].timestamp_us == start_us + 520'000);
+  return status;
+}
+
+[[nodiscard]] bool test_to_state() {
+  const auto state{gamepad::five::to_state(bit(Button::UP) |
+                                           bit(Button::LEFT))};
+  return check("to_state", state.up == 1 && state.down == 0 &&
+                               state.right == 0 && state.left == 1 &&
+                               state.etc == 0);
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+
+  /* once from zero, and once with the microsecond clock about to wrap */
+  for (const uint32_t start_us : {0U, 0xFFFFFFFFU - 250'000}) {
+    status &= tests::test_edges(start_us);
+    status &= tests::test_reset(start_us);
+    status &= tests::test_repeat(start_us);
+    status &= tests::test_late_poll(start_us);
+  }
+  status &= tests::test_to_state();
+
+  if (!status) {
+    std::cerr << "test_button_events failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "gamepad/debounce.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+using gamepad::DebounceStats;
+using gamepad::Debouncer;
+
+/* Bounce traces of the sort tact switches give, as the alarm sees them
+ * polling every 2 ms, '1' for held.  Each starts and ends settled. */
+static constexpr std::string_view PRESS_CLEAN{"0000011111111111111100000000"};
+static constexpr std::string_view PRESS_BOUNCY{
+    "000010110011101111111111111101001011000000000"};
+static constexpr std::string_view RELEASE_CHATTER{
+    "1111111111110111101110100100000000000"};
+static constexpr std::string_view SPIKES{
+    "0000001000000110000000111000000000100000"};
+static constexpr std::string_view TAP_TOO_SHORT{"0000000111000000000"};
+
+/* One input done the slow way: how many polls in a row it has disagreed. */
+struct Reference {
+  bool state{false};
+  uint32_t run{0};
+  uint32_t accepted{0};
+  uint32_t rejected{0};
+
+  bool update(bool sample) {
+    if (sample == state) {
+      rejected += run != 0 ? 1 : 0;
+      run = 0;
+    } else if (++run == 4) {
+      state = sample;
+      run = 0;
+      ++accepted;
+    }
+    return state;
+  }
+};
+
+[[nodiscard]] bool check(const char *name, bool ok) {
+  if (PRINT_DEBUG && !ok) {
+    std::cerr << "  " << name << " failed\n";
+  }
+  return ok;
+}
+
+/* Runs trace through input 0: the sample its output first changes on, and
+ * how many times it changes. */
+[[nodiscard]] std::string_view::size_type
+first_change(std::string_view trace, DebounceStats &stats,
+             uint32_t &changes) {
+  Debouncer deb;
+  deb.reset(trace.front() == '1' ? 1 : 0);
+  std::string_view::size_type first{std::string_view::npos};
+  uint32_t last{deb.state()};
+  changes = 0;
+  for (std::string_view::size_type idx = 0; idx < trace.size(); ++idx) {
+    const uint32_t out{deb.update(trace[idx] == '1' ? 1 : 0)};
+    if (out != last) {
+      ++changes;
+      if (first == std::string_view::npos) {
+        first = idx;
+      }
+    }
+    last = out;
+  }
+  stats = deb.stats();
+  return first;
+}
+
+[[nodiscard]] bool test_traces() {
+  bool status{true};
+  DebounceStats stats;
+  uint32_t changes;
+
+  /* a clean press shows up on its fourth sample, and the release likewise */
+  status &= check("clean press",
+                  first_change(PRESS_CLEAN, stats, changes) == 5 + 3 &&
+                      changes == 2 && stats.accepted == 2 &&
+                      stats.rejected == 0 &&
+                      stats.polls == PRESS_CLEAN.size());
+
+  /* bouncing both ways: one press, one release, and the bounces counted */
+  status &= check("bouncy press",
+                  first_change(PRESS_BOUNCY, stats, changes) == 17 &&
+                      changes == 2 && stats.accepted == 2 &&
+                      stats.rejected == 6);
+
+  /* chatter while letting go still lets go just the once */
+  status &= check("release chatter",
+                  first_change(RELEASE_CHATTER, stats, changes) == 29 &&
+                      changes == 1 && stats.accepted == 1 &&
+                      stats.rejected == 4);
+
+  /* noise three samples or shorter never gets through */
+  status &= check("spikes", first_change(SPIKES, stats, changes) ==
+                                    std::string_view::npos &&
+                                changes == 0 && stats.accepted == 0 &&
+                                stats.rejected == 4);
+  status &= check("too short", first_change(TAP_TOO_SHORT, stats, changes) ==
+                                       std::string_view::npos &&
+                                   stats.rejected == 1);
+  return status;
+}
+
+/* Every trace at once, a bit each, must come out as each did alone. */
+[[nodiscard]] bool test_parallel() {
+  bool status{true};
+  const std::vector<std::string_view> traces{
+      PRESS_CLEAN, PRESS_BOUNCY, RELEASE_CHATTER, SPIKES, TAP_TOO_SHORT,
+      PRESS_BOUNCY, SPIKES, RELEASE_CHATTER};
+  auto &&sample{[](std::string_view trace, size_t idx) {
+    /* past its end a trace stays where it settled */
+    return (idx < trace.size() ? trace[idx] : trace.back()) == '1';
+  }};
+  size_t longest{0};
+  for (const auto trace : traces) {
+    longest = std::max(longest, trace.size());
+  }
+
+  /* the five pad, then all eight */
+  for (const size_t width : {size_t{5}, traces.size()}) {
+    Debouncer deb;
+    std::vector<Reference> refs(width);
+    uint32_t start{0};
+    for (size_t bit = 0; bit < width; ++bit) {
+      refs[bit].state = sample(traces[bit], 0);
+      start |= refs[bit].state ? 1U << bit : 0;
+    }
+    deb.reset(start);
+
+    uint32_t accepted{0}, rejected{0};
+    for (size_t idx = 0; idx < longest; ++idx) {
+      uint32_t raw{0}, expect{0};
+      for (size_t bit = 0; bit < width; ++bit) {
+        const bool in{sample(traces[bit], idx)};
+        raw |= in ? 1U << bit : 0;
+        expect |= refs[bit].update(in) ? 1U << bit : 0;
+      }
+      status &= check("parallel", deb.update(raw) == expect);
+    }
+    for (const auto &ref : refs) {
+      accepted += ref.accepted;
+      rejected += ref.rejected;
+    }
+    status &= check("parallel stats", deb.stats().accepted == accepted &&
+                                          deb.stats().rejected == rejected &&
+                                          deb.stats().polls == longest);
+  }
+  return status;
+}
+
+/* All 32 inputs on noise of varying stickiness, against the reference. */
+[[nodiscard]] bool test_random() {
+  bool status{true};
+  std::mt19937 rng{0x5eed};
+  for (const double flip : {0.02, 0.1, 0.3, 0.5}) {
+    std::bernoulli_distribution flips{flip};
+    Debouncer deb;
+    std::vector<Reference> refs(32);
+    uint32_t raw{0};
+    for (int poll = 0; poll < 5000; ++poll) {
+      uint32_t expect{0};
+      for (uint32_t bit = 0; bit < 32; ++bit) {
+        raw ^= flips(rng) ? 1U << bit : 0;
+        expect |= refs[bit].update((raw >> bit) & 1) ? 1U << bit : 0;
+      }
+      status &= check("random", deb.update(raw) == expect);
+    }
+    uint32_t accepted{0}, rejected{0};
+    for (const auto &ref : refs) {
+      accepted += ref.accepted;
+      rejected += ref.rejected;
+    }
+    status &= check("random stats", deb.stats().accepted == accepted &&
+                                        deb.stats().rejected == rejected);
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_reset() {
+  bool status{true};
+  Debouncer deb;
+  /* part way to a press, then reset to held: no press, and no count left */
+  deb.update(0b1);
+  deb.update(0b1);
+  deb.reset(0b1);
+  status &= check("reset", deb.state() == 0b1);
+  for (int idx = 0; idx < 3; ++idx) {
+    status &= check("reset count", deb.update(0b0) == 0b1);
+  }
+  status &= check("reset release", deb.update(0b0) == 0b0);
+  return status;
+}
+
+/* cheap enough to run at compile time, too */
+static_assert([] {
+  Debouncer deb;
+  for (int idx = 0; idx < 4; ++idx) {
+    deb.update(0b10010);
+  }
+  return deb.state() == 0b10010 && deb.stats().accepted == 2;
+}());
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+
+  status &= tests::test_traces();
+  status &= tests::test_parallel();
+  status &= tests::test_random();
+  status &= tests::test_reset();
+
+  if (!status) {
+    std::cerr << "test_debounce failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
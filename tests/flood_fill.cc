@@ -0,0 +1,216 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "gfx/flood_fill.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+/* a plain byte-per-pixel surface that counts how often it is touched */
+struct Surface {
+  uint32_t w;
+  uint32_t h;
+  std::vector<uint8_t> pixels;
+  mutable uint64_t reads{0};
+  uint64_t writes{0};
+
+  Surface(uint32_t width, uint32_t height, uint8_t value)
+      : w{width}, h{height}, pixels(width * height, value) {}
+
+  [[nodiscard]] uint32_t width() const { return w; }
+  [[nodiscard]] uint32_t height() const { return h; }
+  [[nodiscard]] uint32_t read(uint32_t x, uint32_t y) const {
+    ++reads;
+    return pixels[y * w + x];
+  }
+  void fill(uint32_t y, uint32_t x_start, uint32_t x_finish, uint32_t value) {
+    for (uint32_t x = x_start; x < x_finish; ++x) {
+      pixels[y * w + x] = static_cast<uint8_t>(value);
+      ++writes;
+    }
+  }
+  uint8_t &at(uint32_t x, uint32_t y) { return pixels[y * w + x]; }
+};
+
+/* the obvious, slow way */
+void reference_fill(Surface &s, uint32_t x, uint32_t y, uint8_t value) {
+  const uint8_t old{s.at(x, y)};
+  if (old == value) {
+    return;
+  }
+  std::vector<std::pair<uint32_t, uint32_t>> todo{{x, y}};
+  s.at(x, y) = value;
+  while (!todo.empty()) {
+    const auto [px, py]{todo.back()};
+    todo.pop_back();
+    auto &&visit{[&](uint32_t nx, uint32_t ny) {
+      if (nx < s.w && ny < s.h && s.at(nx, ny) == old) {
+        s.at(nx, ny) = value;
+        todo.emplace_back(nx, ny);
+      }
+    }};
+    visit(px - 1, py);
+    visit(px + 1, py);
+    visit(px, py - 1);
+    visit(px, py + 1);
+  }
+}
+
+/* walls are 1, corridors 0 */
+Surface make_serpentine(uint32_t size) {
+  Surface s{size, size, 0};
+  for (uint32_t y = 1; y < size; y += 2) {
+    for (uint32_t x = 0; x < size; ++x) {
+      s.at(x, y) = 1;
+    }
+    /* alternate the gap between the two ends */
+    s.at(((y >> 1) & 1) ? 0 : size - 1, y) = 0;
+  }
+  return s;
+}
+
+Surface make_comb(uint32_t size) {
+  Surface s{size, size, 0};
+  for (uint32_t x = 1; x < size; x += 2) {
+    for (uint32_t y = 1; y < size; ++y) {
+      s.at(x, y) = 1;
+    }
+  }
+  return s;
+}
+
+/* depth-first carved maze, lots of dead ends and turns */
+Surface make_maze(uint32_t size, std::mt19937 &rng) {
+  Surface s{size, size, 1};
+  const uint32_t cells{(size - 1) / 2};
+  std::vector<std::pair<uint32_t, uint32_t>> path{{0, 0}};
+  s.at(1, 1) = 0;
+  while (!path.empty()) {
+    const auto [cx, cy]{path.back()};
+    std::array<std::pair<int, int>, 4> dirs{
+        {{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+    std::shuffle(std::begin(dirs), std::end(dirs), rng);
+    bool moved{false};
+    for (const auto &[dx, dy] : dirs) {
+      const int nx{static_cast<int>(cx) + dx};
+      const int ny{static_cast<int>(cy) + dy};
+      if (nx < 0 || ny < 0 || nx >= static_cast<int>(cells) ||
+          ny >= static_cast<int>(cells) || s.at(2 * nx + 1, 2 * ny + 1) == 0) {
+        continue;
+      }
+      s.at(2 * cx + 1 + dx, 2 * cy + 1 + dy) = 0;
+      s.at(2 * nx + 1, 2 * ny + 1) = 0;
+      path.emplace_back(nx, ny);
+      moved = true;
+      break;
+    }
+    if (!moved) {
+      path.pop_back();
+    }
+  }
+  return s;
+}
+
+Surface make_noise(uint32_t size, std::mt19937 &rng) {
+  Surface s{size, size, 0};
+  for (auto &pix : s.pixels) {
+    pix = (rng() % 100) < 35 ? 1 : 0;
+  }
+  return s;
+}
+
+[[nodiscard]] bool test_case(const char *name, Surface input, uint32_t x,
+                             uint32_t y) {
+  std::vector<screen::gfx::FloodFillSpan> stack(4096);
+
+  auto expected{input};
+  reference_fill(expected, x, y, 7);
+
+  auto actual{input};
+  const auto start{std::chrono::steady_clock::now()};
+  const bool complete{screen::gfx::flood_fill(actual, x, y, 7, std::data(stack),
+                                              std::size(stack))};
+  const auto elapsed{std::chrono::steady_clock::now() - start};
+
+  uint64_t area{0};
+  for (const auto pix : expected.pixels) {
+    area += pix == 7 ? 1 : 0;
+  }
+
+  bool status{complete && actual.pixels == expected.pixels};
+  /* each filled pixel written once, and only a few reads per pixel */
+  status &= actual.writes == area;
+  const double reads_per_pixel{static_cast<double>(actual.reads) /
+                               static_cast<double>(area)};
+  status &= reads_per_pixel < 4.0;
+
+  if (PRINT_DEBUG) {
+    std::cerr << name << ": " << input.w << "x" << input.h << ", area " << area
+              << ", reads/pixel " << reads_per_pixel << ", "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                     .count()
+              << " us" << (status ? "" : "  <-- FAILED") << "\n";
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_small_stack() {
+  /* a comb needs one stack entry per tooth; give it too few */
+  auto expected{make_comb(64)};
+  reference_fill(expected, 0, 0, 7);
+
+  auto actual{make_comb(64)};
+  std::array<screen::gfx::FloodFillSpan, 4> tiny{};
+  bool status{!screen::gfx::flood_fill(actual, 0, 0, 7, std::data(tiny),
+                                       std::size(tiny))};
+
+  /* with room to spare, it all gets done */
+  std::array<screen::gfx::FloodFillSpan, 256> roomy{};
+  auto retry{make_comb(64)};
+  status &= screen::gfx::flood_fill(retry, 0, 0, 7, std::data(roomy),
+                                    std::size(roomy));
+  status &= retry.pixels == expected.pixels;
+
+  /* seeds off the surface, or already the right value, are no-ops */
+  auto same{make_comb(16)};
+  const auto before{same.pixels};
+  status &= screen::gfx::flood_fill(same, 99, 0, 7, std::data(roomy),
+                                    std::size(roomy));
+  status &= screen::gfx::flood_fill(same, 1, 1, 1, std::data(roomy),
+                                    std::size(roomy));
+  status &= same.pixels == before;
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  std::mt19937 rng{2024};
+
+  for (const uint32_t size : {65U, 129U, 257U}) {
+    status &= tests::test_case("open", tests::Surface{size, size, 0}, size / 2,
+                               size / 2);
+    status &= tests::test_case("serpentine", tests::make_serpentine(size), 0, 0);
+    status &= tests::test_case("comb", tests::make_comb(size), 0, 0);
+    status &= tests::test_case("maze", tests::make_maze(size, rng), 1, 1);
+    status &= tests::test_case("noise", tests::make_noise(size, rng), 0, 0);
+  }
+  status &= tests::test_small_stack();
+
+  if (!status) {
+    std::cerr << "test_flood_fill failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,643 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "st7789_emulator.hpp"
+#include "waveshare_driver/dispLcdCommands.h"
+#include "waveshare_driver/dispRefreshPlan.h"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+static constexpr DispDimensions_t PHYS{.width = 240, .height = 320};
+
+struct Mode {
+  uint8_t depth;
+  uint32_t bpp;
+  DispDimensions_t virt;
+
+  [[nodiscard]] constexpr bool grey() const {
+    return !DISP_DEPTH_IS_CLUT(depth) && depth != DISP_DEPTH_RGB565;
+  }
+};
+
+/* the depths the driver takes, with the virtual screens the app uses */
+static constexpr std::array MODES{
+    Mode{.depth = DISP_DEPTH_GREY1,
+         .bpp = 1,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_GREY2,
+         .bpp = 2,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_GREY4,
+         .bpp = 4,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT1,
+         .bpp = 1,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT2,
+         .bpp = 2,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT4,
+         .bpp = 4,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT8,
+         .bpp = 8,
+         .virt = {.width = 240, .height = 160}},
+    Mode{.depth = DISP_DEPTH_RGB565,
+         .bpp = 16,
+         .virt = {.width = 120, .height = 160}},
+};
+
+[[nodiscard]] const char *name(const Mode &mode) {
+  switch (mode.depth) {
+  case DISP_DEPTH_GREY1:
+    return "GREY1";
+  case DISP_DEPTH_GREY2:
+    return "GREY2";
+  case DISP_DEPTH_GREY4:
+    return "GREY4";
+  case DISP_DEPTH_LUT1:
+    return "LUT1";
+  case DISP_DEPTH_LUT2:
+    return "LUT2";
+  case DISP_DEPTH_LUT4:
+    return "LUT4";
+  case DISP_DEPTH_LUT8:
+    return "LUT8";
+  default:
+    return "RGB565";
+  }
+}
+
+/* the driver's bus, wired straight into the emulated panel */
+DispLcdBus_t bus_to(St7789Emulator &panel) {
+  return {.writeCmd = [](void *ctx, uint8_t cmd) {
+            static_cast<St7789Emulator *>(ctx)->command(cmd);
+          },
+          .writeData = [](void *ctx, uint8_t data) {
+            static_cast<St7789Emulator *>(ctx)->data(data);
+          },
+          .ctx = &panel};
+}
+
+struct Frame {
+  Mode mode;
+  std::vector<uint8_t> bytes;
+  std::array<uint16_t, 256> clut{};
+
+  explicit Frame(const Mode &m)
+      : mode{m}, bytes(m.virt.width * m.virt.height * m.bpp / 8) {}
+
+  [[nodiscard]] uint32_t pixel(uint32_t x, uint32_t y) const {
+    const uint32_t bit{(y * mode.virt.width + x) * mode.bpp};
+    if (mode.bpp == 16) {
+      return static_cast<uint32_t>(bytes[bit / 8] | bytes[bit / 8 + 1] << 8);
+    }
+    return bytes[bit / 8] >> (bit % 8) & ((1U << mode.bpp) - 1);
+  }
+
+  /* what the picture should look like, whatever it went through on the way */
+  [[nodiscard]] St7789Emulator::Rgb666 colour(uint32_t x, uint32_t y) const {
+    const uint32_t value{pixel(x, y)};
+    switch (mode.depth) {
+    case DISP_DEPTH_GREY1:
+      return St7789Emulator::from_rgb444(value * 15, value * 15, value * 15);
+    case DISP_DEPTH_GREY2:
+      return St7789Emulator::from_rgb444(value * 5, value * 5, value * 5);
+    case DISP_DEPTH_GREY4:
+      return St7789Emulator::from_rgb444(value, value, value);
+    case DISP_DEPTH_RGB565:
+      return St7789Emulator::from_rgb565(value);
+    default:
+      return St7789Emulator::from_rgb565(clut[value]);
+    }
+  }
+};
+
+/* What the PIO puts on the wire for a plan's runs.  Grey samples are
+ * replicated to 12 bits (RGB444, packed two pixels to three bytes); CLUT
+ * entries and native pixels go out as RGB565, most significant byte first. */
+[[nodiscard]] std::vector<uint8_t> pio_wire(const Frame &frame,
+                                            const DispRefreshPlan_t &plan) {
+  const auto &mode{frame.mode};
+  std::vector<uintptr_t> table(plan.runs + 1);
+  dispPlanRunTable(&plan, std::data(frame.bytes), std::data(table));
+  const auto base{reinterpret_cast<uintptr_t>(std::data(frame.bytes))};
+
+  std::vector<uint8_t> wire;
+  std::vector<uint32_t> samples;
+  for (uint32_t run = 0; table[run] != 0; ++run) {
+    const uint64_t first_bit{(table[run] - base) * 8};
+    const uint64_t bits{uint64_t{plan.runXfers} * plan.xferBytes * 8};
+    for (uint64_t bit = first_bit; bit < first_bit + bits; bit += mode.bpp) {
+      const auto index{static_cast<uint32_t>(bit / mode.bpp)};
+      const uint32_t value{
+          frame.pixel(index % mode.virt.width, index / mode.virt.width)};
+      if (mode.grey()) {
+        uint32_t sample{0};
+        for (uint32_t copy = 0; copy < 12 / mode.bpp; ++copy) {
+          sample = sample << mode.bpp | value;
+        }
+        samples.push_back(sample);
+      } else {
+        const uint32_t rgb565{mode.depth == DISP_DEPTH_RGB565
+                                  ? value
+                                  : frame.clut[value]};
+        wire.push_back(static_cast<uint8_t>(rgb565 >> 8));
+        wire.push_back(static_cast<uint8_t>(rgb565));
+      }
+    }
+  }
+  for (size_t idx = 0; idx + 1 < std::size(samples); idx += 2) {
+    wire.push_back(static_cast<uint8_t>(samples[idx] >> 4));
+    wire.push_back(
+        static_cast<uint8_t>(samples[idx] << 4 | samples[idx + 1] >> 8));
+    wire.push_back(static_cast<uint8_t>(samples[idx + 1]));
+  }
+  return wire;
+}
+
+/* The state machines, step for step as dispWaveshareLcd.c programs them,
+ * run over the framebuffer words the DMA feeds in.  Checks pio_wire() against
+ * the programs rather than against itself. */
+class PioModel {
+public:
+  explicit PioModel(const Frame &frame) : m_frame{frame} {}
+
+  [[nodiscard]] std::vector<uint8_t> scan() {
+    const auto &mode{m_frame.mode};
+    const auto &bytes{m_frame.bytes};
+    if (mode.depth == DISP_DEPTH_RGB565) {
+      /* halfword DMA: the bus copies it to both halves of the FIFO word */
+      for (size_t idx = 0; idx < std::size(bytes); idx += 2) {
+        const uint32_t half{
+            static_cast<uint32_t>(bytes[idx] | bytes[idx + 1] << 8)};
+        send_msb_first(half << 16 | half, 16);
+      }
+      return pack();
+    }
+
+    for (size_t idx = 0; idx < std::size(bytes); idx += 4) {
+      /* autopull, OSR shifts right */
+      m_osr = static_cast<uint32_t>(bytes[idx] | bytes[idx + 1] << 8 |
+                                    bytes[idx + 2] << 16 |
+                                    bytes[idx + 3] << 24);
+      m_osr_count = 0;
+      while (m_osr_count < 32) {
+        DISP_DEPTH_IS_CLUT(mode.depth) ? clut_pixel() : grey_pixel();
+      }
+    }
+    return pack();
+  }
+
+private:
+  static constexpr uint32_t CLUT_ADDR{0x20001200}; /* 512 byte aligned */
+
+  [[nodiscard]] uint32_t out(uint32_t count) {
+    const uint32_t value{count == 32 ? m_osr : m_osr & ((1U << count) - 1)};
+    m_osr = count == 32 ? 0 : m_osr >> count;
+    m_osr_count += count;
+    return value;
+  }
+  /* ISR shifts right, so bits go in at the top */
+  void in(uint32_t value, uint32_t count) {
+    value &= count == 32 ? ~0U : (1U << count) - 1;
+    m_isr = count == 32 ? value : (m_isr >> count) | value << (32 - count);
+  }
+  [[nodiscard]] uint32_t push() {
+    const uint32_t value{m_isr};
+    m_isr = 0;
+    return value;
+  }
+
+  /* SM0: out bpp -> Y, in Y bpp, 12 / bpp times; autopush at 12 */
+  void grey_pixel() {
+    const uint32_t bpp{m_frame.mode.bpp};
+    const uint32_t y{out(bpp)};
+    for (uint32_t x = 12 / bpp; x > 0; --x) {
+      in(y, bpp);
+    }
+    /* SM1 pulls it and shifts 12 bits out, OSR to the left */
+    send_msb_first(push(), 12);
+  }
+
+  /* SM0: out bpp -> Y, in 1 zero, in Y bpp, in 8 - bpp zeroes, in 23 X */
+  void clut_pixel() {
+    const uint32_t bpp{m_frame.mode.bpp};
+    const uint32_t y{out(bpp)};
+    in(0, 1);
+    in(y, bpp);
+    if (bpp != 8) {
+      in(0, 9 - (bpp + 1));
+    }
+    in(CLUT_ADDR >> 9, 32 - 9);
+    const uint32_t address{push()};
+
+    /* the DMA reads the halfword there, SM1 shifts 16 bits out */
+    const uint32_t entry{(address - CLUT_ADDR) / 2};
+    m_bad_address |= address % 2 != 0 || address < CLUT_ADDR ||
+                     entry >= std::size(m_frame.clut);
+    const uint32_t half{m_bad_address ? 0U : m_frame.clut[entry]};
+    send_msb_first(half << 16 | half, 16);
+  }
+
+  void send_msb_first(uint32_t word, uint32_t count) {
+    for (uint32_t bit = 0; bit < count; ++bit) {
+      m_bits.push_back((word >> (31 - bit)) & 1);
+    }
+  }
+
+  [[nodiscard]] std::vector<uint8_t> pack() const {
+    if (m_bad_address) {
+      return {};
+    }
+    std::vector<uint8_t> wire(std::size(m_bits) / 8);
+    for (size_t idx = 0; idx < std::size(wire) * 8; ++idx) {
+      wire[idx / 8] = static_cast<uint8_t>(wire[idx / 8] << 1 | m_bits[idx]);
+    }
+    return wire;
+  }
+
+  const Frame &m_frame;
+  uint32_t m_osr{0};
+  uint32_t m_osr_count{0};
+  uint32_t m_isr{0};
+  bool m_bad_address{false};
+  std::vector<uint8_t> m_bits;
+};
+
+/* window, then pixels: what the driver sends for one refresh */
+void send(St7789Emulator &panel, const Frame &frame,
+          const DispRefreshPlan_t &plan) {
+  const auto bus{bus_to(panel)};
+  dispLcdWriteWindow(&bus, &plan);
+  const auto wire{pio_wire(frame, plan)};
+  panel.bytes(std::data(wire), std::size(wire), true);
+}
+
+[[nodiscard]] bool panel_shows(const St7789Emulator &panel,
+                               const Frame &frame) {
+  const uint32_t col0{(PHYS.width - frame.mode.virt.width) / 2};
+  const uint32_t row0{(PHYS.height - frame.mode.virt.height) / 2};
+  for (uint32_t y = 0; y < PHYS.height; ++y) {
+    for (uint32_t x = 0; x < PHYS.width; ++x) {
+      const bool inside{x >= col0 && x < col0 + frame.mode.virt.width &&
+                        y >= row0 && y < row0 + frame.mode.virt.height};
+      const auto expected{inside ? frame.colour(x - col0, y - row0)
+                                 : St7789Emulator::Rgb666{}};
+      if (!(panel.at(x, y) == expected)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void randomize(Frame &frame, std::mt19937 &rng) {
+  for (auto &byte : frame.bytes) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  for (auto &entry : frame.clut) {
+    entry = static_cast<uint16_t>(rng());
+  }
+}
+
+[[nodiscard]] bool test_pio_expansion() {
+  std::mt19937 rng{41};
+  bool status{true};
+  for (const auto &mode : MODES) {
+    Frame frame{mode};
+    randomize(frame, rng);
+
+    const DispRect_t all{.x = 0, .y = 0, .width = 240, .height = 320};
+    DispRefreshPlan_t plan{};
+    status &= dispPlanRefresh(&all, mode.depth, mode.virt, PHYS, &plan);
+
+    const auto expected{pio_wire(frame, plan)};
+    const auto actual{PioModel{frame}.scan()};
+    const bool same{!expected.empty() && actual == expected &&
+                    std::size(actual) == plan.wireBytes};
+    status &= same;
+    if (PRINT_DEBUG) {
+      std::cerr << name(mode) << ": " << std::size(frame.bytes)
+                << " framebuffer bytes, " << std::size(actual)
+                << " on the wire" << (same ? "" : "  <-- FAILED") << "\n";
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_init() {
+  bool status{true};
+  for (const auto &mode : MODES) {
+    St7789Emulator panel;
+    const auto bus{bus_to(panel)};
+    dispLcdWriteInit(&bus, mode.depth, 0);
+
+    status &= !panel.sleeping() && panel.display_on();
+    status &= panel.madctl() == 0;
+    status &= panel.colmod() ==
+              (mode.grey() ? ST7789_COLMOD_RGB444 : ST7789_COLMOD_RGB565);
+    status &= panel.command_count(ST7789_DISPON) == 1;
+    status &= panel.pixels_written() == 0;
+
+    /* a frame of white, then the blanking the driver does on first power up */
+    St7789Emulator::Rgb666 white{};
+    {
+      DispRefreshPlan_t all{};
+      all.width = 240;
+      all.height = 320;
+      dispLcdWriteWindow(&bus, &all);
+      for (uint32_t idx = 0; idx < 240 * 320 * 3 / 2 + 240 * 320 / 2; ++idx) {
+        panel.data(0xff);
+      }
+      white = panel.at(17, 300);
+    }
+    panel.reset_counters();
+    dispLcdWriteBlank(&bus, PHYS);
+    bool black{true};
+    for (uint32_t y = 0; y < PHYS.height; ++y) {
+      for (uint32_t x = 0; x < PHYS.width; ++x) {
+        black &= panel.at(x, y) == St7789Emulator::Rgb666{};
+      }
+    }
+    status &= !(white == St7789Emulator::Rgb666{}) && black;
+    status &= panel.command_bytes() == 3;
+    status &= panel.pixel_bytes() == 240 * 320 * 2;
+  }
+  return status;
+}
+
+/* a depth change on a panel that is already up: COLMOD if the wire format
+ * changes, then the new frame, and nothing of the init sequence again */
+[[nodiscard]] bool test_depth_switch() {
+  std::mt19937 rng{42};
+  bool status{true};
+
+  for (const auto &from : MODES) {
+    for (const auto &to : MODES) {
+      St7789Emulator panel;
+      const auto bus{bus_to(panel)};
+      dispLcdWriteInit(&bus, from.depth, 0);
+      dispLcdWriteBlank(&bus, PHYS);
+      const uint8_t colmod{dispLcdColmod(from.depth)};
+
+      Frame frame{to};
+      randomize(frame, rng);
+      const DispRect_t all{.x = 0, .y = 0, .width = 240, .height = 320};
+      DispRefreshPlan_t plan{};
+      status &= dispPlanRefresh(&all, to.depth, to.virt, PHYS, &plan);
+
+      panel.reset_counters();
+      const bool new_format{dispLcdColmod(to.depth) != colmod};
+      if (new_format) {
+        dispLcdWriteColmod(&bus, to.depth);
+      }
+      send(panel, frame, plan);
+
+      bool switch_ok{panel_shows(panel, frame)};
+      switch_ok &= panel.colmod() == dispLcdColmod(to.depth);
+      switch_ok &= panel.command_bytes() == (new_format ? 4U : 3U);
+      switch_ok &= panel.command_count(ST7789_SLPOUT) == 0;
+      switch_ok &= panel.command_count(ST7789_DISPON) == 0;
+      switch_ok &= !panel.sleeping() && panel.display_on();
+      status &= switch_ok;
+      if (PRINT_DEBUG && !switch_ok) {
+        std::cerr << name(from) << " -> " << name(to) << "  <-- FAILED\n";
+      }
+    }
+  }
+  return status;
+}
+
+/* Where a panel address lands on the glass under an orientation, worked out
+ * from the datasheet's MADCTL description rather than from the emulator. */
+[[nodiscard]] std::pair<uint32_t, uint32_t> glass_of(uint8_t orientation,
+                                                     uint32_t col,
+                                                     uint32_t row) {
+  const bool swap{(orientation & DISP_ORIENT_SWAP_XY) != 0};
+  const uint32_t cols{swap ? PHYS.height : PHYS.width};
+  const uint32_t rows{swap ? PHYS.width : PHYS.height};
+  if (orientation & DISP_ORIENT_MIRROR_X) {
+    col = cols - 1 - col;
+  }
+  if (orientation & DISP_ORIENT_MIRROR_Y) {
+    row = rows - 1 - row;
+  }
+  return swap ? std::pair{row, col} : std::pair{col, row};
+}
+
+/* the driver's orientations: MADCTL at init, the physical and virtual sizes
+ * swapped, the virtual screen centered in the turned panel */
+[[nodiscard]] bool test_orientation() {
+  std::mt19937 rng{45};
+  bool status{true};
+
+  /* the top left of the picture goes round the glass a quarter at a time */
+  static constexpr std::array<uint8_t, 4> TURNS{
+      0, DISP_ORIENT_SWAP_XY | DISP_ORIENT_MIRROR_X,
+      DISP_ORIENT_MIRROR_X | DISP_ORIENT_MIRROR_Y,
+      DISP_ORIENT_SWAP_XY | DISP_ORIENT_MIRROR_Y};
+  status &= glass_of(TURNS[0], 0, 0) == std::pair{0U, 0U};
+  status &= glass_of(TURNS[1], 0, 0) == std::pair{0U, 319U};
+  status &= glass_of(TURNS[2], 0, 0) == std::pair{239U, 319U};
+  status &= glass_of(TURNS[3], 0, 0) == std::pair{239U, 0U};
+
+  for (const auto &mode : MODES) {
+    for (const uint8_t turn : TURNS) {
+      for (const uint8_t orientation :
+           {turn, static_cast<uint8_t>(turn ^ DISP_ORIENT_MIRROR_X)}) {
+        const bool swap{(orientation & DISP_ORIENT_SWAP_XY) != 0};
+        const DispDimensions_t phys{swap ? DispDimensions_t{PHYS.height,
+                                                            PHYS.width}
+                                         : PHYS};
+        Mode turned{mode};
+        if (swap) {
+          turned.virt = {.width = mode.virt.height, .height = mode.virt.width};
+        }
+
+        St7789Emulator panel;
+        const auto bus{bus_to(panel)};
+        dispLcdWriteInit(&bus, turned.depth, orientation);
+        dispLcdWriteBlank(&bus, phys);
+
+        Frame frame{turned};
+        randomize(frame, rng);
+        const DispRect_t all{.x = 0, .y = 0, .width = 320, .height = 320};
+        DispRefreshPlan_t plan{};
+        status &= dispPlanRefresh(&all, turned.depth, turned.virt, phys, &plan);
+        send(panel, frame, plan);
+
+        std::vector<St7789Emulator::Rgb666> expected(PHYS.width *
+                                                     PHYS.height);
+        const uint32_t col0{(phys.width - turned.virt.width) / 2};
+        const uint32_t row0{(phys.height - turned.virt.height) / 2};
+        for (uint32_t y = 0; y < turned.virt.height; ++y) {
+          for (uint32_t x = 0; x < turned.virt.width; ++x) {
+            const auto [gx, gy]{glass_of(orientation, col0 + x, row0 + y)};
+            expected[gy * PHYS.width + gx] = frame.colour(x, y);
+          }
+        }
+        bool turn_ok{panel.madctl() == orientation};
+        for (uint32_t y = 0; y < PHYS.height; ++y) {
+          for (uint32_t x = 0; x < PHYS.width; ++x) {
+            turn_ok &= panel.at(x, y) == expected[y * PHYS.width + x];
+          }
+        }
+        status &= turn_ok;
+        if (PRINT_DEBUG && !turn_ok) {
+          std::cerr << name(mode) << " MADCTL " << int{orientation}
+                    << "  <-- FAILED\n";
+        }
+      }
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_frames(const char *dump_dir) {
+  std::mt19937 rng{40};
+  bool status{true};
+
+  for (const auto &mode : MODES) {
+    St7789Emulator panel;
+    const auto bus{bus_to(panel)};
+    dispLcdWriteInit(&bus, mode.depth, 0);
+    dispLcdWriteBlank(&bus, PHYS);
+
+    Frame frame{mode};
+    randomize(frame, rng);
+
+    /* the whole virtual screen, centered */
+    const DispRect_t all{.x = 0, .y = 0, .width = 240, .height = 320};
+    DispRefreshPlan_t plan{};
+    status &= dispPlanRefresh(&all, mode.depth, mode.virt, PHYS, &plan);
+    panel.reset_counters();
+    send(panel, frame, plan);
+    bool frame_ok{panel_shows(panel, frame)};
+    frame_ok &= panel.pixel_bytes() == plan.wireBytes;
+    frame_ok &= panel.command_bytes() == 3;
+    frame_ok &= panel.pixels_written() == mode.virt.width * mode.virt.height;
+
+    /* then regions of changes; the picture keeps up with the framebuffer */
+    uint64_t region_bytes{0};
+    for (int trial = 0; trial < 40; ++trial) {
+      const DispRect_t rect{
+          .x = static_cast<uint32_t>(rng() % mode.virt.width),
+          .y = static_cast<uint32_t>(rng() % mode.virt.height),
+          .width = 1 + static_cast<uint32_t>(rng() % 32),
+          .height = 1 + static_cast<uint32_t>(rng() % 32)};
+      for (uint32_t y = rect.y;
+           y < std::min(rect.y + rect.height, mode.virt.height); ++y) {
+        for (uint32_t x = rect.x;
+             x < std::min(rect.x + rect.width, mode.virt.width); ++x) {
+          const uint32_t bit{(y * mode.virt.width + x) * mode.bpp};
+          frame.bytes[bit / 8] ^= static_cast<uint8_t>(
+              (rng() | 1) & ((1U << std::min(mode.bpp, 8U)) - 1)
+                                << (bit % 8));
+        }
+      }
+      status &= dispPlanRefresh(&rect, mode.depth, mode.virt, PHYS, &plan);
+      panel.reset_counters();
+      send(panel, frame, plan);
+      frame_ok &= panel.pixel_bytes() == plan.wireBytes;
+      region_bytes += panel.command_bytes() + panel.data_bytes();
+    }
+    frame_ok &= panel_shows(panel, frame);
+    status &= frame_ok;
+
+    if (PRINT_DEBUG) {
+      std::cerr << name(mode) << ": frame "
+                << dispPlanWireBytes(mode.depth,
+                                     mode.virt.width * mode.virt.height)
+                << " bytes, 40 regions " << region_bytes << " bytes"
+                << (frame_ok ? "" : "  <-- FAILED") << "\n";
+    }
+    if (dump_dir != nullptr) {
+      std::ofstream out{std::string{dump_dir} + "/" + name(mode) + ".ppm",
+                        std::ios::binary};
+      panel.write_ppm(out);
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_madctl() {
+  bool status{true};
+  auto &&one_pixel{[](St7789Emulator &panel, uint8_t madctl, uint16_t col,
+                      uint16_t row) {
+    const uint16_t seq[]{0x8036, madctl, 0x803a, 0x05,
+                         0x802a, static_cast<uint16_t>(col >> 8),
+                         static_cast<uint16_t>(col & 0xff), 0x00, 0x00,
+                         0x802b, static_cast<uint16_t>(row >> 8),
+                         static_cast<uint16_t>(row & 0xff), 0x00, 0x00,
+                         0x802c, 0xff, 0xff};
+    panel.sequence(std::data(seq), std::size(seq));
+  }};
+  auto &&lit{[](const St7789Emulator &panel, uint32_t x, uint32_t y) {
+    return panel.at(x, y) == St7789Emulator::from_rgb565(0xffff);
+  }};
+
+  {
+    St7789Emulator panel;
+    one_pixel(panel, 0x00, 10, 20);
+    status &= lit(panel, 10, 20);
+  }
+  {
+    /* MX and MY: turned half way round */
+    St7789Emulator panel;
+    one_pixel(panel, 0xc0, 10, 20);
+    status &= lit(panel, 229, 299);
+  }
+  {
+    /* MV: columns run down the glass, 320 of them */
+    St7789Emulator panel;
+    one_pixel(panel, 0x20, 300, 20);
+    status &= lit(panel, 20, 300);
+  }
+  {
+    /* the address counters wrap inside the window, and only there */
+    St7789Emulator panel;
+    const uint16_t seq[]{0x803a, 0x05, 0x802a, 0x00, 0x05, 0x00, 0x06,
+                         0x802b, 0x00, 0x07, 0x00, 0x07, 0x802c};
+    panel.sequence(std::data(seq), std::size(seq));
+    for (int idx = 0; idx < 3; ++idx) {
+      panel.data(0xff);
+      panel.data(0xff);
+    }
+    status &= lit(panel, 5, 7) && lit(panel, 6, 7) && !lit(panel, 7, 7);
+    status &= !lit(panel, 5, 8) && panel.pixels_written() == 3;
+  }
+  return status;
+}
+
+} // namespace tests
+
+/* pass a directory to get the final picture of each mode as a PPM */
+int main(int argc, char **argv) {
+  bool status{true};
+  status &= tests::test_init();
+  status &= tests::test_pio_expansion();
+  status &= tests::test_madctl();
+  status &= tests::test_depth_switch();
+  status &= tests::test_orientation();
+  status &= tests::test_frames(argc > 1 ? argv[1] : nullptr);
+
+  if (!status) {
+    std::cerr << "test_lcd_emulator failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,199 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gfx/line_walk.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+using screen::gfx::IntensityRamp;
+using screen::gfx::Point;
+
+/* odd sizes, so rows don't land on word boundaries */
+static constexpr screen::Dimensions DIM{.width = 72, .height = 50};
+
+/* Wu's line the obvious way, exactly, as a level per pixel (0 is unlit).
+ * Same conventions as draw_line_aa: walk the major axis from the end nearer
+ * the origin, the end point is not drawn, the brighter level wins.  A step
+ * exactly half way between two levels may go either way, so ties_up picks.
+ *
+ * The minor coordinate at step k is minor0 + k * dminor / major_len, kept as
+ * a whole numerator over major_len so that no rounding sneaks in. */
+[[nodiscard]] std::vector<int> reference_line(Point p1, Point p2,
+                                              uint32_t levels, bool ties_up) {
+  std::vector<int> out(DIM.width * DIM.height, 0);
+  const int64_t dx{static_cast<int64_t>(p2.x) - p1.x};
+  const int64_t dy{static_cast<int64_t>(p2.y) - p1.y};
+  const bool x_major{std::abs(dy) < std::abs(dx)};
+  if ((x_major ? p1.x > p2.x : p1.y > p2.y)) {
+    std::swap(p1, p2);
+  }
+  const int64_t major_len{x_major ? std::abs(dx) : std::abs(dy)};
+  const int64_t dminor{x_major ? static_cast<int64_t>(p2.y) - p1.y
+                               : static_cast<int64_t>(p2.x) - p1.x};
+  const int64_t top{static_cast<int64_t>(levels) - 1};
+
+  auto &&plot{[&](int64_t x, int64_t y, int64_t level) {
+    if (x < 0 || y < 0 || x >= DIM.width || y >= DIM.height ||
+        (level == 0 && top != 0)) {
+      return;
+    }
+    int &px{out[static_cast<size_t>(y * DIM.width + x)]};
+    /* a single level ramp paints with level 0; count it as lit */
+    px = std::max(px, top == 0 ? 1 : static_cast<int>(level));
+  }};
+  auto &&floor_div{[](int64_t num, int64_t den) {
+    return num / den - (num % den != 0 && num < 0 ? 1 : 0);
+  }};
+  for (int64_t k = 0; k < major_len; ++k) {
+    const int64_t major{(x_major ? p1.x : p1.y) + k};
+    const int64_t num{(x_major ? p1.y : p1.x) * major_len + k * dminor};
+    const int64_t near{floor_div(num, major_len)};
+    /* far pixel's share, rem / major_len of the way, in levels */
+    const int64_t rem{num - near * major_len};
+    const int64_t far_level{
+        ties_up ? floor_div(2 * rem * top + major_len, 2 * major_len)
+                : floor_div(2 * rem * top + major_len - 1, 2 * major_len)};
+    if (x_major) {
+      plot(major, near, top - far_level);
+      plot(major, near + 1, far_level);
+    } else {
+      plot(near, major, top - far_level);
+      plot(near + 1, major, far_level);
+    }
+  }
+  return out;
+}
+
+/* draw_line_aa's own code, into a packed buffer, read back as levels */
+template <uint32_t BPP>
+[[nodiscard]] std::vector<int> actual_line(Point p1, Point p2,
+                                           IntensityRamp ramp) {
+  const uint32_t pitch{DIM.width * BPP / 8};
+  std::vector<uint8_t> frame(pitch * DIM.height, 0);
+  screen::gfx::details::draw_wu_line<BPP>(std::data(frame), p1, p2, DIM, ramp);
+
+  std::vector<int> out(DIM.width * DIM.height, 0);
+  for (uint32_t y = 0; y < DIM.height; ++y) {
+    for (uint32_t x = 0; x < DIM.width; ++x) {
+      const uint32_t bit{y * pitch * 8 + x * BPP};
+      const uint32_t value{(frame[bit / 8] >> (bit % 8)) & ((1U << BPP) - 1)};
+      if (ramp.levels == 1) {
+        out[y * DIM.width + x] = value == ramp.base && value != 0 ? 1 : 0;
+      } else if (value >= ramp.base && value != 0) {
+        out[y * DIM.width + x] = static_cast<int>(value - ramp.base);
+      }
+    }
+  }
+  return out;
+}
+
+[[nodiscard]] bool check(const char *name, bool ok) {
+  if (PRINT_DEBUG && !ok) {
+    std::cerr << "  " << name << " failed\n";
+  }
+  return ok;
+}
+
+template <uint32_t BPP>
+[[nodiscard]] bool test_against_reference(const char *name,
+                                          IntensityRamp ramp,
+                                          std::mt19937 &rng) {
+  bool status{true};
+  /* end points are unsigned, so off screen is past the right or bottom */
+  std::uniform_int_distribution<uint32_t> xs{0, DIM.width + 30};
+  std::uniform_int_distribution<uint32_t> ys{0, DIM.height + 30};
+
+  std::vector<std::pair<Point, Point>> lines{
+      {{0, 0}, {71, 49}},  {{71, 0}, {0, 49}},  {{3, 10}, {60, 10}},
+      {{20, 2}, {20, 47}}, {{5, 5}, {45, 45}},  {{0, 49}, {71, 48}},
+      {{70, 1}, {69, 49}}, {{10, 40}, {90, 3}}, {{100, 60}, {0, 0}}};
+  for (int idx = 0; idx < 3000; ++idx) {
+    lines.push_back({{xs(rng), ys(rng)}, {xs(rng), ys(rng)}});
+  }
+
+  size_t lit{0};
+  size_t differ{0};
+  int worst{0};
+  for (const auto &[p1, p2] : lines) {
+    const auto down{reference_line(p1, p2, ramp.levels, false)};
+    const auto up{reference_line(p1, p2, ramp.levels, true)};
+    const auto actual{actual_line<BPP>(p1, p2, ramp)};
+    for (size_t px = 0; px < std::size(actual); ++px) {
+      const int lo{std::min(down[px], up[px])};
+      const int hi{std::max(down[px], up[px])};
+      if (hi == 0 && actual[px] == 0) {
+        continue;
+      }
+      ++lit;
+      const int off{actual[px] < lo   ? lo - actual[px]
+                    : actual[px] > hi ? actual[px] - hi
+                                      : 0};
+      differ += off != 0 ? 1 : 0;
+      worst = std::max(worst, off);
+    }
+    /* and drawn backwards, it's the same line */
+    status &= check("reversed", actual == actual_line<BPP>(p2, p1, ramp));
+  }
+
+  /* fixed point rounding can tip a pixel to the next level, but rarely */
+  status &= check("worst level", worst <= 1);
+  status &= check("how often", differ * 100 < lit);
+  if (PRINT_DEBUG && !status) {
+    std::cerr << "test_against_reference " << name << ": " << differ << " of "
+              << lit << " pixels differ, worst by " << worst << "\n";
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_erase() {
+  /* a single level ramp paints the whole line solid, over another ramp */
+  const IntensityRamp ramp{.base = 8, .levels = 8};
+  const IntensityRamp erase{.base = 3, .levels = 1};
+  const uint32_t pitch{DIM.width * 4 / 8};
+  std::vector<uint8_t> frame(pitch * DIM.height, 0);
+  screen::gfx::details::draw_wu_line<4>(std::data(frame), {2, 3}, {60, 30},
+                                        DIM, ramp);
+  screen::gfx::details::draw_wu_line<4>(std::data(frame), {2, 3}, {60, 30},
+                                        DIM, erase);
+  return check("erase", std::all_of(std::begin(frame), std::end(frame),
+                                    [](uint8_t byte) {
+                                      const int lo{byte & 0xF};
+                                      const int hi{byte >> 4};
+                                      return (lo == 0 || lo == 3) &&
+                                             (hi == 0 || hi == 3);
+                                    }) &&
+                            std::any_of(std::begin(frame), std::end(frame),
+                                        [](uint8_t byte) { return byte != 0; }));
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  std::mt19937 rng{1234};
+
+  status &= tests::test_against_reference<4>("LUT4", {.base = 8, .levels = 8},
+                                             rng);
+  status &= tests::test_against_reference<8>(
+      "LUT8", {.base = 0x40, .levels = 64}, rng);
+  status &= tests::test_against_reference<2>("GREY2", {.base = 0, .levels = 4},
+                                             rng);
+  status &= tests::test_against_reference<4>(
+      "GREY4", {.base = 0, .levels = 16}, rng);
+  status &= tests::test_erase();
+
+  if (!status) {
+    std::cerr << "test_line_aa failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,304 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "waveshare_driver/dispRefreshPlan.h"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+static constexpr DispDimensions_t PHYS{.width = 240, .height = 320};
+
+struct Mode {
+  uint8_t depth;
+  uint32_t bpp;
+  DispDimensions_t virt;
+
+  /* RGB444 for the grey modes, RGB565 for everything else */
+  [[nodiscard]] constexpr uint32_t wire_bits() const {
+    return DISP_DEPTH_IS_CLUT(depth) || depth == DISP_DEPTH_RGB565 ? 16 : 12;
+  }
+};
+
+/* the depths the driver takes, with the virtual screens the app uses */
+static constexpr std::array MODES{
+    Mode{.depth = DISP_DEPTH_GREY1,
+         .bpp = 1,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_GREY2,
+         .bpp = 2,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_GREY4,
+         .bpp = 4,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT1,
+         .bpp = 1,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT2,
+         .bpp = 2,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT4,
+         .bpp = 4,
+         .virt = {.width = 240, .height = 320}},
+    Mode{.depth = DISP_DEPTH_LUT8,
+         .bpp = 8,
+         .virt = {.width = 240, .height = 160}},
+    Mode{.depth = DISP_DEPTH_RGB565,
+         .bpp = 16,
+         .virt = {.width = 120, .height = 160}},
+};
+
+/* Stands in for the panel end of the SPI bus: takes the command words the
+ * driver would send, then pixels, and remembers where each pixel landed. */
+struct PanelStandIn {
+  std::vector<int64_t> ram; /* framebuffer pixel index, -1 if never written */
+  uint16_t col_start{0}, col_end{0}, row_start{0}, row_end{0};
+  uint16_t col{0}, row{0};
+  uint64_t cmd_bytes{0};
+  uint64_t wire_half_bytes{0};
+
+  PanelStandIn() : ram(PHYS.width * PHYS.height, -1) {}
+
+  [[nodiscard]] bool command(const uint16_t *seq, uint32_t len) {
+    std::vector<uint8_t> args;
+    uint8_t cmd{0};
+    auto &&finish{[&]() {
+      if (cmd == 0x2a && args.size() == 4) {
+        col_start = static_cast<uint16_t>(args[0] << 8 | args[1]);
+        col_end = static_cast<uint16_t>(args[2] << 8 | args[3]);
+      } else if (cmd == 0x2b && args.size() == 4) {
+        row_start = static_cast<uint16_t>(args[0] << 8 | args[1]);
+        row_end = static_cast<uint16_t>(args[2] << 8 | args[3]);
+      } else if (cmd == 0x2c && args.empty()) {
+        col = col_start;
+        row = row_start;
+      } else if (cmd != 0) {
+        return false;
+      }
+      return true;
+    }};
+    bool status{true};
+    for (uint32_t idx = 0; idx < len; ++idx) {
+      ++cmd_bytes;
+      if (seq[idx] >> 15) {
+        status &= finish();
+        cmd = static_cast<uint8_t>(seq[idx]);
+        args.clear();
+      } else {
+        args.push_back(static_cast<uint8_t>(seq[idx]));
+      }
+    }
+    status &= finish();
+    return status;
+  }
+
+  void pixel(int64_t fb_index, uint32_t half_bytes) {
+    ram[row * PHYS.width + col] = fb_index;
+    wire_half_bytes += half_bytes;
+    if (col++ == col_end) {
+      col = col_start;
+      if (row++ == row_end) {
+        row = row_start;
+      }
+    }
+  }
+};
+
+/* Run the DMA: read the runs out of the framebuffer, as pixel indices */
+[[nodiscard]] bool stream(const DispRefreshPlan_t &plan, const Mode &mode,
+                          PanelStandIn &panel) {
+  const uint32_t pitch{mode.virt.width * mode.bpp / 8};
+  const std::vector<uint8_t> framebuffer(pitch * mode.virt.height);
+  const auto base{reinterpret_cast<uintptr_t>(std::data(framebuffer))};
+  std::vector<uintptr_t> table(plan.runs + 1);
+  dispPlanRunTable(&plan, std::data(framebuffer), std::data(table));
+
+  /* the zero ends the chain */
+  bool status{table[plan.runs] == 0};
+  for (uint32_t run = 0; run < plan.runs; ++run) {
+    const uint64_t first_byte{table[run] - base};
+    const uint64_t bytes{plan.runXfers * plan.xferBytes};
+    status &= first_byte + bytes <= std::size(framebuffer);
+    for (uint64_t bit = first_byte * 8; bit < (first_byte + bytes) * 8;
+         bit += mode.bpp) {
+      const uint64_t y{bit / 8 / pitch};
+      const uint64_t x{(bit - y * pitch * 8) / mode.bpp};
+      /* RGB444 is 3 half bytes a pixel, RGB565 is 4 */
+      panel.pixel(static_cast<int64_t>(y * mode.virt.width + x),
+                  mode.wire_bits() / 4);
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool check_rect(const Mode &mode, const DispRect_t &rect) {
+  DispRefreshPlan_t plan{};
+  const bool on_screen{dispPlanRefresh(&rect, mode.depth, mode.virt, PHYS,
+                                       &plan)};
+  if (!on_screen) {
+    return rect.x >= mode.virt.width || rect.y >= mode.virt.height ||
+           rect.width == 0 || rect.height == 0;
+  }
+
+  bool status{true};
+  const uint32_t col0{(PHYS.width - mode.virt.width) / 2};
+  const uint32_t row0{(PHYS.height - mode.virt.height) / 2};
+
+  /* covers the (clipped) rect, stays on the virtual screen */
+  const uint32_t x0{plan.panelCol - col0};
+  const uint32_t y0{plan.panelRow - row0};
+  status &= x0 <= rect.x && y0 <= rect.y;
+  status &= x0 + plan.width >= std::min(rect.x + rect.width, mode.virt.width);
+  status &=
+      y0 + plan.height >= std::min(rect.y + rect.height, mode.virt.height);
+  status &= x0 + plan.width <= mode.virt.width;
+  status &= y0 + plan.height <= mode.virt.height;
+
+  /* the DMA reads whole, aligned transfers, exactly the window's pixels */
+  status &= plan.fbOffset % plan.xferBytes == 0;
+  status &= plan.runStride % plan.xferBytes == 0;
+  status &= static_cast<uint64_t>(plan.runs) * plan.runXfers * plan.xferBytes *
+                8 ==
+            static_cast<uint64_t>(plan.width) * plan.height * mode.bpp;
+
+  /* and a whole number of bytes goes out, even at 12 bits a pixel */
+  status &= (static_cast<uint64_t>(plan.width) * plan.height *
+             mode.wire_bits()) %
+                8 ==
+            0;
+  status &= plan.wireBytes ==
+            static_cast<uint64_t>(plan.width) * plan.height *
+                mode.wire_bits() / 8;
+
+  /* now over the stand-in bus: every pixel lands where it belongs */
+  PanelStandIn panel;
+  std::array<uint16_t, DISP_PLAN_WINDOW_SEQ_LEN> seq{};
+  const auto len{dispPlanWindowSeq(&plan, std::data(seq))};
+  status &= len == DISP_PLAN_WINDOW_SEQ_LEN;
+  status &= panel.command(std::data(seq), len);
+  status &= stream(plan, mode, panel);
+  status &= panel.wire_half_bytes == 2ULL * plan.wireBytes;
+  status &= panel.cmd_bytes == DISP_PLAN_WINDOW_SEQ_LEN;
+
+  for (uint32_t row = 0; row < PHYS.height; ++row) {
+    for (uint32_t col = 0; col < PHYS.width; ++col) {
+      const bool inside{col >= plan.panelCol &&
+                        col < plan.panelCol + plan.width &&
+                        row >= plan.panelRow &&
+                        row < plan.panelRow + plan.height};
+      const int64_t expected{
+          inside ? static_cast<int64_t>((row - row0) * mode.virt.width +
+                                        (col - col0))
+                 : -1};
+      status &= panel.ram[row * PHYS.width + col] == expected;
+    }
+  }
+
+  if (!status && PRINT_DEBUG) {
+    std::cerr << "depth " << static_cast<int>(mode.depth) << " rect "
+              << rect.x << "," << rect.y << " " << rect.width << "x"
+              << rect.height << " -> " << plan.panelCol << "," << plan.panelRow
+              << " " << plan.width << "x" << plan.height << " runs "
+              << plan.runs << " x " << plan.runXfers << "  <-- FAILED\n";
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_random_rects() {
+  std::mt19937 rng{39};
+  bool status{true};
+  for (const auto &mode : MODES) {
+    for (int trial = 0; trial < 300; ++trial) {
+      auto &&below{[&](uint32_t limit) {
+        return static_cast<uint32_t>(rng() % limit);
+      }};
+      const DispRect_t rect{.x = below(mode.virt.width + 8),
+                            .y = below(mode.virt.height + 8),
+                            .width = below(mode.virt.width + 1),
+                            .height = below(40)};
+      status &= check_rect(mode, rect);
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_known_streams() {
+  bool status{true};
+
+  /* the whole LUT4 screen is the window the driver always used */
+  {
+    const DispRect_t all{.x = 0, .y = 0, .width = 240, .height = 320};
+    DispRefreshPlan_t plan{};
+    status &=
+        dispPlanRefresh(&all, DISP_DEPTH_LUT4, MODES[5].virt, PHYS, &plan);
+    std::array<uint16_t, DISP_PLAN_WINDOW_SEQ_LEN> seq{};
+    static_cast<void>(dispPlanWindowSeq(&plan, std::data(seq)));
+    status &= seq == std::array<uint16_t, DISP_PLAN_WINDOW_SEQ_LEN>{
+                         0x802a, 0x00, 0x00, 0x00, 0xef, 0x802b, 0x00, 0x00,
+                         0x01, 0x3f, 0x802c};
+    status &= plan.runs == 1 && plan.runXfers == 240 * 320 / 2 / 4;
+    status &= plan.wireBytes == 240 * 320 * 2;
+  }
+
+  /* a small sprite-sized update in LUT8 is centered, widened to words */
+  {
+    const DispRect_t rect{.x = 13, .y = 7, .width = 6, .height = 8};
+    DispRefreshPlan_t plan{};
+    status &=
+        dispPlanRefresh(&rect, DISP_DEPTH_LUT8, MODES[6].virt, PHYS, &plan);
+    status &= plan.panelCol == 12 && plan.width == 8;
+    status &= plan.panelRow == 80 + 7 && plan.height == 8;
+    status &= plan.runs == 8 && plan.runXfers == 2 && plan.runStride == 240;
+    status &= plan.wireBytes == 8 * 8 * 2;
+  }
+
+  /* 1bpp rows are 30 bytes, so updates become bands from an even row */
+  {
+    const DispRect_t rect{.x = 100, .y = 3, .width = 4, .height = 2};
+    DispRefreshPlan_t plan{};
+    status &=
+        dispPlanRefresh(&rect, DISP_DEPTH_GREY1, MODES[0].virt, PHYS, &plan);
+    status &= plan.panelCol == 0 && plan.width == 240;
+    status &= plan.panelRow == 2 && plan.height == 4;
+    status &= plan.runs == 1 && plan.fbOffset == 60;
+    status &= plan.wireBytes == 240 * 4 * 12 / 8;
+  }
+
+  /* a small update is a small fraction of the bus traffic */
+  {
+    const DispRect_t rect{.x = 40, .y = 40, .width = 16, .height = 16};
+    DispRefreshPlan_t plan{};
+    status &=
+        dispPlanRefresh(&rect, DISP_DEPTH_LUT4, MODES[5].virt, PHYS, &plan);
+    const auto full{dispPlanWireBytes(DISP_DEPTH_LUT4, 240 * 320)};
+    if (PRINT_DEBUG) {
+      std::cerr << "16x16 LUT4 update: " << plan.wireBytes << " of " << full
+                << " bytes\n";
+    }
+    status &= plan.wireBytes * 200 < full;
+  }
+
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  status &= tests::test_known_streams();
+  status &= tests::test_random_rects();
+
+  if (!status) {
+    std::cerr << "test_refresh_plan failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "TileDef.h"
+#include "sprite_cache.hpp"
+
+using screen::Format;
+using screen::Tile;
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+static constexpr size_t WIDTH{32};
+static constexpr size_t HEIGHT{12};
+
+/* pixel 0 is the least significant bits of a byte */
+[[nodiscard]] uint32_t peek(const uint8_t *row, size_t x, size_t bpp) {
+  const size_t bit{x * bpp};
+  return (row[bit / 8] >> (bit % 8)) & ((1U << bpp) - 1U);
+}
+void poke(uint8_t *row, size_t x, size_t bpp, uint32_t value) {
+  const size_t bit{x * bpp};
+  const uint32_t mask{((1U << bpp) - 1U) << (bit % 8)};
+  row[bit / 8] = (row[bit / 8] & ~mask) | ((value << (bit % 8)) & mask);
+}
+
+[[nodiscard]] bool test_format(Format fmt, uint8_t side, std::mt19937 &rng) {
+  bool status{true};
+  const size_t bpp{screen::bitsizeof(fmt)};
+  const size_t pitch{WIDTH * bpp / 8};
+  const size_t tile_pitch{(side * bpp + 7) / 8};
+
+  std::array<uint8_t, 64> tile_data{};
+  std::generate(std::begin(tile_data), std::end(tile_data), rng);
+  const Tile tile{.side_length = side, .format = fmt, .data = tile_data.data()};
+
+  screen::sprite_cache::clear();
+  status &= screen::sprite_cache::add(tile);
+
+  for (size_t y = 0; y + side <= HEIGHT; y += 3) {
+    for (size_t x = 0; x + side <= WIDTH; ++x) {
+      std::array<uint8_t, WIDTH * HEIGHT * 4 / 8> actual{};
+      std::generate(std::begin(actual), std::end(actual), rng);
+      auto expected{actual};
+
+      for (size_t yy = 0; yy < side; ++yy) {
+        for (size_t xx = 0; xx < side; ++xx) {
+          poke(expected.data() + (y + yy) * pitch, x + xx, bpp,
+               peek(tile.data + yy * tile_pitch, xx, bpp));
+        }
+      }
+      status &= screen::sprite_cache::blit(actual.data(), WIDTH, x, y, tile);
+
+      const bool result{expected == actual};
+      if (!result && PRINT_DEBUG) {
+        std::cerr << "test_sprite_cache, bpp = " << bpp
+                  << ", side = " << +side << ", x = " << x << ", y = " << y
+                  << '\n';
+      }
+      status &= result;
+    }
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_budget() {
+  bool status{true};
+  static constexpr std::array<uint8_t, 8> dummy{};
+  screen::sprite_cache::clear();
+
+  /* only sub-byte formats are cached */
+  status &= !screen::sprite_cache::add(
+      {.side_length = 8, .format = Format::RGB565_LUT8, .data = dummy.data()});
+
+  /* fill the entry table, then make sure we stop */
+  std::array<uint8_t, SPRITE_CACHE_ENTRIES + 1> keys{};
+  for (size_t idx = 0; idx < SPRITE_CACHE_ENTRIES; ++idx) {
+    status &= screen::sprite_cache::add(
+        {.side_length = 1, .format = Format::GREY1, .data = &keys[idx]});
+  }
+  status &= !screen::sprite_cache::add({.side_length = 1,
+                                        .format = Format::GREY1,
+                                        .data = &keys[SPRITE_CACHE_ENTRIES]});
+  screen::sprite_cache::clear();
+  status &= screen::sprite_cache::bytes_used() == 0;
+
+  /* an uncached tile is left for the regular blitters */
+  std::array<uint8_t, WIDTH> buf{};
+  status &= !screen::sprite_cache::blit(
+      buf.data(), WIDTH, 1, 0,
+      {.side_length = 8, .format = Format::GREY1, .data = dummy.data()});
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  std::mt19937 rng{4321};
+
+  for (const auto fmt : {Format::GREY1, Format::GREY2, Format::GREY4,
+                         Format::RGB565_LUT2, Format::RGB565_LUT4}) {
+    for (const uint8_t side : {1, 5, 8, 12}) {
+      status &= tests::test_format(fmt, side, rng);
+    }
+  }
+  status &= tests::test_budget();
+
+  if (!status) {
+    std::cerr << "test_sprite_cache failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
@@ -0,0 +1,247 @@
+#if !defined(TESTS_ST7789_EMULATOR_HPP)
+#define TESTS_ST7789_EMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <ostream>
+#include <vector>
+
+namespace tests {
+
+/** @brief Enough of an ST7789 to check what the driver sends it.
+ *
+ *  Takes the byte stream off the bus, command or data, and keeps the panel's
+ * RAM as 18-bit colour, the way the controller stores it.  Knows CASET, RASET,
+ * RAMWR, RAMWRC, COLMOD (RGB444 and RGB565) and MADCTL (MY, MX, MV); other
+ * commands are counted and their arguments swallowed.  Counts every byte, so
+ * bandwidth changes can be checked exactly.
+ */
+class St7789Emulator {
+public:
+  static constexpr uint16_t WIDTH{240};
+  static constexpr uint16_t HEIGHT{320};
+
+  struct Rgb666 {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    [[nodiscard]] constexpr bool operator==(const Rgb666 &) const = default;
+  };
+
+  St7789Emulator() : m_ram(WIDTH * HEIGHT, Rgb666{}) {}
+
+  void command(uint8_t cmd) {
+    ++m_command_bytes;
+    ++m_command_counts[cmd];
+    m_cmd = cmd;
+    m_args.clear();
+    m_partial.clear();
+
+    switch (cmd) {
+    case 0x01: /* SWRESET */
+      m_colmod = 0x06;
+      m_madctl = 0;
+      m_sleeping = true;
+      m_display_on = false;
+      m_col_start = m_row_start = 0;
+      m_col_end = WIDTH - 1;
+      m_row_end = HEIGHT - 1;
+      break;
+    case 0x10: /* SLPIN */
+      m_sleeping = true;
+      break;
+    case 0x11: /* SLPOUT */
+      m_sleeping = false;
+      break;
+    case 0x28: /* DISPOFF */
+      m_display_on = false;
+      break;
+    case 0x29: /* DISPON */
+      m_display_on = true;
+      break;
+    case 0x2c: /* RAMWR */
+      m_col = m_col_start;
+      m_row = m_row_start;
+      break;
+    default:
+      break;
+    }
+  }
+
+  void data(uint8_t value) {
+    ++m_data_bytes;
+    switch (m_cmd) {
+    case 0x2a: /* CASET */
+      argument(value, 4, [this]() {
+        m_col_start = word(0);
+        m_col_end = word(2);
+      });
+      break;
+    case 0x2b: /* RASET */
+      argument(value, 4, [this]() {
+        m_row_start = word(0);
+        m_row_end = word(2);
+      });
+      break;
+    case 0x36: /* MADCTL */
+      argument(value, 1, [this]() { m_madctl = m_args[0]; });
+      break;
+    case 0x3a: /* COLMOD */
+      argument(value, 1, [this]() { m_colmod = m_args[0]; });
+      break;
+    case 0x2c: /* RAMWR */
+    case 0x3c: /* RAMWRC */
+      ++m_pixel_bytes;
+      pixel_byte(value);
+      break;
+    default:
+      m_args.push_back(value);
+      break;
+    }
+  }
+
+  /** @brief Feed a run of bytes, all with the same D/C. */
+  void bytes(const uint8_t *values, size_t count, bool is_data) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      is_data ? data(values[idx]) : command(values[idx]);
+    }
+  }
+
+  /** @brief The driver's own sequence format: high bit means command. */
+  void sequence(const uint16_t *seq, size_t len) {
+    for (size_t idx = 0; idx < len; ++idx) {
+      (seq[idx] >> 15) ? command(static_cast<uint8_t>(seq[idx]))
+                       : data(static_cast<uint8_t>(seq[idx]));
+    }
+  }
+
+  /** @brief A pixel, in panel coordinates (portrait, as the glass is). */
+  [[nodiscard]] Rgb666 at(uint32_t x, uint32_t y) const {
+    return m_ram[y * WIDTH + x];
+  }
+
+  /** @brief The panel RAM as a binary PPM, 8 bits a channel. */
+  void write_ppm(std::ostream &out) const {
+    out << "P6\n" << WIDTH << " " << HEIGHT << "\n255\n";
+    for (const auto &pix : m_ram) {
+      for (const uint8_t channel : {pix.r, pix.g, pix.b}) {
+        out.put(static_cast<char>(channel << 2 | channel >> 4));
+      }
+    }
+  }
+
+  [[nodiscard]] static constexpr Rgb666 from_rgb444(uint32_t r, uint32_t g,
+                                                    uint32_t b) {
+    return {.r = static_cast<uint8_t>(r << 2 | r >> 2),
+            .g = static_cast<uint8_t>(g << 2 | g >> 2),
+            .b = static_cast<uint8_t>(b << 2 | b >> 2)};
+  }
+  [[nodiscard]] static constexpr Rgb666 from_rgb565(uint32_t value) {
+    const uint32_t r{value >> 11 & 0x1f};
+    const uint32_t b{value & 0x1f};
+    return {.r = static_cast<uint8_t>(r << 1 | r >> 4),
+            .g = static_cast<uint8_t>(value >> 5 & 0x3f),
+            .b = static_cast<uint8_t>(b << 1 | b >> 4)};
+  }
+
+  [[nodiscard]] bool sleeping() const { return m_sleeping; }
+  [[nodiscard]] bool display_on() const { return m_display_on; }
+  [[nodiscard]] uint8_t colmod() const { return m_colmod; }
+  [[nodiscard]] uint8_t madctl() const { return m_madctl; }
+  [[nodiscard]] uint64_t command_bytes() const { return m_command_bytes; }
+  [[nodiscard]] uint64_t data_bytes() const { return m_data_bytes; }
+  [[nodiscard]] uint64_t pixel_bytes() const { return m_pixel_bytes; }
+  [[nodiscard]] uint64_t pixels_written() const { return m_pixels_written; }
+  [[nodiscard]] uint32_t command_count(uint8_t cmd) const {
+    return m_command_counts[cmd];
+  }
+  void reset_counters() {
+    m_command_bytes = m_data_bytes = m_pixel_bytes = m_pixels_written = 0;
+    m_command_counts = {};
+  }
+
+private:
+  template <class Done>
+  void argument(uint8_t value, size_t expected, Done &&done) {
+    m_args.push_back(value);
+    if (m_args.size() == expected) {
+      done();
+    }
+  }
+  [[nodiscard]] uint16_t word(size_t idx) const {
+    return static_cast<uint16_t>(m_args[idx] << 8 | m_args[idx + 1]);
+  }
+
+  void pixel_byte(uint8_t value) {
+    m_partial.push_back(value);
+    if (m_colmod == 0x03 && m_partial.size() == 3) {
+      /* two pixels in three bytes: RG BR GB */
+      put(from_rgb444(m_partial[0] >> 4, m_partial[0] & 0xf,
+                      m_partial[1] >> 4));
+      put(from_rgb444(m_partial[1] & 0xf, m_partial[2] >> 4,
+                      m_partial[2] & 0xf));
+      m_partial.clear();
+    } else if (m_colmod == 0x05 && m_partial.size() == 2) {
+      put(from_rgb565(static_cast<uint32_t>(m_partial[0] << 8 | m_partial[1])));
+      m_partial.clear();
+    } else if (m_colmod == 0x06 && m_partial.size() == 3) {
+      put({.r = static_cast<uint8_t>(m_partial[0] >> 2),
+           .g = static_cast<uint8_t>(m_partial[1] >> 2),
+           .b = static_cast<uint8_t>(m_partial[2] >> 2)});
+      m_partial.clear();
+    }
+  }
+
+  /* write at the address counters, then step them through the window */
+  void put(Rgb666 colour) {
+    const bool mv{(m_madctl & 0x20) != 0};
+    const uint32_t col_limit{mv ? HEIGHT : WIDTH};
+    const uint32_t row_limit{mv ? WIDTH : HEIGHT};
+    uint32_t col{m_col};
+    uint32_t row{m_row};
+    if (m_madctl & 0x40) {
+      col = col_limit - 1 - col;
+    }
+    if (m_madctl & 0x80) {
+      row = row_limit - 1 - row;
+    }
+    const uint32_t x{mv ? row : col};
+    const uint32_t y{mv ? col : row};
+    if (x < WIDTH && y < HEIGHT) {
+      m_ram[y * WIDTH + x] = colour;
+    }
+    ++m_pixels_written;
+
+    if (m_col++ == m_col_end) {
+      m_col = m_col_start;
+      if (m_row++ == m_row_end) {
+        m_row = m_row_start;
+      }
+    }
+  }
+
+  std::vector<Rgb666> m_ram;
+  std::vector<uint8_t> m_args;
+  std::vector<uint8_t> m_partial;
+  std::array<uint32_t, 256> m_command_counts{};
+  uint8_t m_cmd{0};
+  uint8_t m_colmod{0x06};
+  uint8_t m_madctl{0};
+  bool m_sleeping{true};
+  bool m_display_on{false};
+  uint16_t m_col_start{0};
+  uint16_t m_col_end{WIDTH - 1};
+  uint16_t m_row_start{0};
+  uint16_t m_row_end{HEIGHT - 1};
+  uint16_t m_col{0};
+  uint16_t m_row{0};
+  uint64_t m_command_bytes{0};
+  uint64_t m_data_bytes{0};
+  uint64_t m_pixel_bytes{0};
+  uint64_t m_pixels_written{0};
+};
+
+} // namespace tests
+#endif
@@ -0,0 +1,184 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "TileBuffer.hpp"
+#include "orientation.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+/* small buffers whose rows don't land on word boundaries */
+static constexpr size_t WIDTH{40};
+static constexpr size_t HEIGHT{11};
+
+template <size_t BPP> struct Reference {
+  static constexpr size_t PITCH{WIDTH * BPP / 8};
+  static constexpr size_t BUFLEN{PITCH * HEIGHT + 4};
+
+  /* pixel x of row y; pixel 0 is the least significant bits of a byte */
+  [[nodiscard]] static uint32_t peek(const std::array<uint8_t, BUFLEN> &buf,
+                                     size_t x, size_t y) {
+    const size_t bit{y * PITCH * 8 + x * BPP};
+    if constexpr (BPP == 16) {
+      return buf[bit / 8] | (buf[bit / 8 + 1] << 8);
+    } else {
+      return (buf[bit / 8] >> (bit % 8)) & ((1U << BPP) - 1U);
+    }
+  }
+  static void poke(std::array<uint8_t, BUFLEN> &buf, size_t x, size_t y,
+                   uint32_t value) {
+    const size_t bit{y * PITCH * 8 + x * BPP};
+    if constexpr (BPP == 16) {
+      buf[bit / 8] = value & 0xff;
+      buf[bit / 8 + 1] = (value >> 8) & 0xff;
+    } else {
+      const uint32_t mask{((1U << BPP) - 1U) << (bit % 8)};
+      buf[bit / 8] = (buf[bit / 8] & ~mask) | ((value << (bit % 8)) & mask);
+    }
+  }
+
+  /* the obvious, slow way */
+  static void scroll(std::array<uint8_t, BUFLEN> &buf, int dx, int dy,
+                     uint32_t fill, screen::gfx::Rect region) {
+    const auto src{buf};
+    const int x0{static_cast<int>(region.topleft.x)};
+    const int y0{static_cast<int>(region.topleft.y)};
+    const int x1{std::min<int>(x0 + region.size.width, WIDTH)};
+    const int y1{std::min<int>(y0 + region.size.height, HEIGHT)};
+    for (int yy = y0; yy < y1; ++yy) {
+      for (int xx = x0; xx < x1; ++xx) {
+        const int sx{xx - dx};
+        const int sy{yy - dy};
+        const bool inside{sx >= x0 && sx < x1 && sy >= y0 && sy < y1};
+        poke(buf, xx, yy, inside ? peek(src, sx, sy) : fill);
+      }
+    }
+  }
+};
+
+template <size_t BPP> [[nodiscard]] bool test_scroll(std::mt19937 &rng) {
+  using Ref = Reference<BPP>;
+  using Buffer = TileBuffer<WIDTH, HEIGHT, BPP, Ref::BUFLEN>;
+
+  bool status{true};
+  const uint32_t fill{BPP == 16 ? 0xA55AU : (1U << BPP) - 2U};
+
+  auto &&test_apparatus{[&](int dx, int dy, screen::gfx::Rect region) {
+    typename Buffer::buffer_type actual{};
+    std::generate(std::begin(actual), std::end(actual), rng);
+    auto expected{actual};
+
+    Buffer tilebuf{actual};
+    scroll(tilebuf, dx, dy, fill, region);
+    Ref::scroll(expected, dx, dy, fill, region);
+
+    const bool result{expected == actual};
+    if (!result && PRINT_DEBUG) {
+      std::cerr << "test_scroll<" << BPP << ">, dx = " << dx << ", dy = " << dy
+                << ", region = {" << region.topleft.x << ", "
+                << region.topleft.y << ", " << region.size.width << ", "
+                << region.size.height << "}\n";
+    }
+    return result;
+  }};
+
+  const screen::gfx::Rect whole{.topleft = {0, 0}, .size = {WIDTH, HEIGHT}};
+  const screen::gfx::Rect full_rows{.topleft = {0, 2}, .size = {WIDTH, 7}};
+  const screen::gfx::Rect inset{.topleft = {3, 1}, .size = {29, 9}};
+  const screen::gfx::Rect clipped{.topleft = {5, 4}, .size = {100, 100}};
+
+  for (const auto region : {whole, full_rows, inset, clipped}) {
+    for (int dy = -12; dy <= 12; dy += 3) {
+      for (int dx = -41; dx <= 41; ++dx) {
+        status &= test_apparatus(dx, dy, region);
+      }
+    }
+  }
+
+  /* the legacy byte-count interfaces */
+  {
+    typename Buffer::buffer_type actual{};
+    std::generate(std::begin(actual), std::end(actual), rng);
+    auto expected{actual};
+    Buffer tilebuf{actual};
+    scroll_up(tilebuf, 2);
+    Ref::scroll(expected, 0, -2, BPP == 16 ? 0xFFFFU : (1U << BPP) - 1U, whole);
+    status &= expected == actual;
+  }
+
+  return status;
+}
+
+template <class Buffer>
+[[nodiscard]] bool draws_only_upright(screen::Dimensions upright) {
+  const auto sideways{
+      screen::orientation::turned(upright, screen::Orientation::LANDSCAPE)};
+  return Buffer::laid_out_for(upright.width, upright.height) &&
+         !Buffer::laid_out_for(sideways.width, sideways.height);
+}
+
+/* set_orientation() with the screen's own buffers: the console stays upright,
+ * anything goes otherwise, and the tile buffers then draw nothing turned. */
+[[nodiscard]] bool test_orientation() {
+  using screen::Orientation;
+  namespace orientation = screen::orientation;
+  static constexpr screen::Dimensions PANEL{.width = 240, .height = 320};
+  static constexpr size_t PANEL_BUFLEN{PANEL.width * PANEL.height * 4 / 8};
+  using Console = TileBuffer<PANEL.width, PANEL.height, 1, PANEL_BUFLEN>;
+
+  bool status{true};
+  for (const auto turn : {Orientation::PORTRAIT, Orientation::LANDSCAPE,
+                          Orientation::PORTRAIT_FLIPPED,
+                          Orientation::LANDSCAPE_FLIPPED}) {
+    const bool sideways{orientation::swaps_axes(turn)};
+    const auto dims{orientation::turned(PANEL, turn)};
+    status &= sideways ? dims.width == PANEL.height && dims.height == PANEL.width
+                       : dims.width == PANEL.width && dims.height == PANEL.height;
+
+    /* refused in console mode exactly when on its side */
+    status &= orientation::accepts<Console>(turn, true, PANEL) == !sideways;
+    status &= orientation::accepts<Console>(turn, false, PANEL);
+  }
+
+  /* each format's tile buffer, on the full screen for it, upright and turned */
+  status &= draws_only_upright<Console>(PANEL);
+  status &= draws_only_upright<TileBuffer<240, 320, 2, PANEL_BUFLEN>>(PANEL);
+  status &= draws_only_upright<TileBuffer<240, 320, 4, PANEL_BUFLEN>>(PANEL);
+  status &= draws_only_upright<TileBuffer<240, 160, 8, PANEL_BUFLEN>>(
+      {.width = 240, .height = 160});
+  status &= draws_only_upright<TileBuffer<120, 160, 16, PANEL_BUFLEN>>(
+      {.width = 120, .height = 160});
+  if (!status && PRINT_DEBUG) {
+    std::cerr << "test_orientation\n";
+  }
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  std::mt19937 rng{1234};
+
+  const bool status_1bpp{tests::test_scroll<1>(rng)};
+  const bool status_2bpp{tests::test_scroll<2>(rng)};
+  const bool status_4bpp{tests::test_scroll<4>(rng)};
+  const bool status_8bpp{tests::test_scroll<8>(rng)};
+  const bool status_16bpp{tests::test_scroll<16>(rng)};
+  status = status_1bpp && status_2bpp && status_4bpp && status_8bpp &&
+           status_16bpp;
+  status &= tests::test_orientation();
+  if (!status) {
+    std::cerr << "test_scroll failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
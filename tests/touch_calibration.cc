@@ -0,0 +1,258 @@
+#include <iostream>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+
+#include "touch_calibration.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+using screen::TouchCalibration;
+using screen::TouchCalibrationRecord;
+namespace tc = screen::touch_calibration;
+
+static constexpr screen::Dimensions GLASS{.width = 240, .height = 320};
+
+/* a real affine map, the way a panel might be mounted: scaled, flipped,
+ * turned a few degrees and shifted */
+struct Truth {
+  double sx;
+  double sy;
+  double degrees;
+  double ox;
+  double oy;
+
+  [[nodiscard]] std::pair<double, double> operator()(double rx,
+                                                     double ry) const {
+    const double t{degrees * 3.14159265358979 / 180.0};
+    return {sx * (std::cos(t) * rx - std::sin(t) * ry) + ox,
+            sy * (std::sin(t) * rx + std::cos(t) * ry) + oy};
+  }
+};
+
+/* where the raw sample lands, unclamped, in floating point */
+[[nodiscard]] std::pair<double, double> reference(const TouchCalibration &cal,
+                                                  int32_t rx, int32_t ry) {
+  return {(cal.xx * double{1} * rx + cal.xy * double{1} * ry + cal.x0) /
+              65536.0,
+          (cal.yx * double{1} * rx + cal.yy * double{1} * ry + cal.y0) /
+              65536.0};
+}
+
+[[nodiscard]] bool test_crc() {
+  /* the standard check value */
+  const char *check{"123456789"};
+  static_assert(tc::crc32(nullptr, 0) == 0);
+  return tc::crc32(reinterpret_cast<const uint8_t *>(check),
+                   std::strlen(check)) == 0xCBF43926;
+}
+
+/* three targets and what an ideal controller reads at them: the fit has to
+ * reproduce the map everywhere else, to within rounding */
+[[nodiscard]] bool test_fit(const Truth &truth, std::mt19937 &rng) {
+  /* raw points spread over the panel, and where they land; the targets are
+   * those landings rounded to whole pixels, like the crosses drawn */
+  const std::array<std::pair<int32_t, int32_t>, 3> raws{
+      {{500, 600}, {3300, 2000}, {1500, 3500}}};
+  tc::Point pts[3];
+  for (size_t idx = 0; idx < 3; ++idx) {
+    const auto [px, py]{truth(raws[idx].first, raws[idx].second)};
+    pts[idx] = {.raw_x = raws[idx].first,
+                .raw_y = raws[idx].second,
+                .x = static_cast<int32_t>(std::lround(px)),
+                .y = static_cast<int32_t>(std::lround(py))};
+  }
+
+  TouchCalibration cal{};
+  if (!tc::fit(pts, cal)) {
+    if (PRINT_DEBUG) {
+      std::cerr << "  fit refused a good point set\n";
+    }
+    return false;
+  }
+
+  /* the targets themselves come back exactly */
+  bool status{true};
+  for (const auto &pt : pts) {
+    const auto got{tc::map(cal, pt.raw_x, pt.raw_y, GLASS)};
+    status &= got.x == pt.x && got.y == pt.y;
+  }
+
+  /* anywhere on the glass, close to the truth; the targets were rounded to
+   * whole pixels, which tilts the map a little, more so out past them */
+  std::uniform_int_distribution<int32_t> raw{0, tc::RAW_MAX};
+  double worst{0};
+  for (int idx = 0; idx < 2000; ++idx) {
+    const int32_t rx{raw(rng)}, ry{raw(rng)};
+    const auto [tx, ty]{truth(rx, ry)};
+    const auto [fx, fy]{reference(cal, rx, ry)};
+    if (tx >= 0 && tx < GLASS.width && ty >= 0 && ty < GLASS.height) {
+      worst = std::max({worst, std::abs(tx - fx), std::abs(ty - fy)});
+    }
+
+    /* and the integer map is the floating one, rounded, then clamped */
+    const auto got{tc::map(cal, rx, ry, GLASS)};
+    const auto want_x{std::clamp(static_cast<int>(std::floor(fx + 0.5)), 0,
+                                 static_cast<int>(GLASS.width) - 1)};
+    const auto want_y{std::clamp(static_cast<int>(std::floor(fy + 0.5)), 0,
+                                 static_cast<int>(GLASS.height) - 1)};
+    status &= got.x == want_x && got.y == want_y;
+  }
+  status &= worst < 1.5;
+  if (PRINT_DEBUG && !status) {
+    std::cerr << "  fit off by up to " << worst << " px\n";
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_degenerate() {
+  bool status{true};
+  TouchCalibration cal{.xx = 1, .xy = 2, .x0 = 3, .yx = 4, .yy = 5, .y0 = 6};
+  const TouchCalibration before{cal};
+
+  /* all in a line */
+  const tc::Point line[3]{{.raw_x = 100, .raw_y = 100, .x = 10, .y = 10},
+                          {.raw_x = 200, .raw_y = 200, .x = 20, .y = 20},
+                          {.raw_x = 300, .raw_y = 300, .x = 30, .y = 30}};
+  status &= !tc::fit(line, cal);
+
+  /* the same spot pressed three times */
+  const tc::Point same[3]{{.raw_x = 100, .raw_y = 100, .x = 10, .y = 10},
+                          {.raw_x = 100, .raw_y = 100, .x = 200, .y = 20},
+                          {.raw_x = 100, .raw_y = 100, .x = 30, .y = 300}};
+  status &= !tc::fit(same, cal);
+
+  /* far too steep: a few raw steps across the whole screen */
+  const tc::Point steep[3]{{.raw_x = 100, .raw_y = 100, .x = 0, .y = 0},
+                           {.raw_x = 101, .raw_y = 100, .x = 239, .y = 0},
+                           {.raw_x = 100, .raw_y = 101, .x = 0, .y = 319}};
+  status &= !tc::fit(steep, cal);
+
+  status &= std::memcmp(&cal, &before, sizeof(cal)) == 0;
+  return status;
+}
+
+/* the built in calibration is the line the touch demo fit by hand, which it
+ * then drew mirrored */
+[[nodiscard]] bool test_default() {
+  bool status{true};
+  for (int32_t rx = 0; rx <= tc::RAW_MAX; rx += 13) {
+    for (int32_t ry = 0; ry <= tc::RAW_MAX; ry += 17) {
+      const auto col{static_cast<int>(std::lround(0.071343 * rx - 17.836))};
+      const auto row{static_cast<int>(std::lround(0.091143 * ry - 31.9))};
+      const auto got{tc::map(tc::DEFAULT, rx, ry, GLASS)};
+      const auto want_x{239 - std::clamp(col, 0, 239)};
+      const auto want_y{319 - std::clamp(row, 0, 319)};
+      status &= std::abs(got.x - want_x) <= 1 && std::abs(got.y - want_y) <= 1;
+    }
+  }
+  /* no cross terms when the points are square to each other */
+  status &= tc::DEFAULT.xy == 0 && tc::DEFAULT.yx == 0;
+  return status;
+}
+
+/* Where a panel address lands on the glass under MADCTL, the same way the
+ * LCD emulator test works it out. */
+[[nodiscard]] std::pair<int32_t, int32_t> glass_of(bool swap, bool mx, bool my,
+                                                   int32_t col, int32_t row) {
+  const auto cols{static_cast<int32_t>(swap ? GLASS.height : GLASS.width)};
+  const auto rows{static_cast<int32_t>(swap ? GLASS.width : GLASS.height)};
+  if (mx) {
+    col = cols - 1 - col;
+  }
+  if (my) {
+    row = rows - 1 - row;
+  }
+  return swap ? std::pair{row, col} : std::pair{col, row};
+}
+
+[[nodiscard]] bool test_reoriented(std::mt19937 &rng) {
+  bool status{true};
+  std::uniform_int_distribution<int32_t> raw{300, 3700};
+  for (uint32_t flags = 0; flags < 8; ++flags) {
+    const bool swap{(flags & 1) != 0};
+    const bool mx{(flags & 2) != 0};
+    const bool my{(flags & 4) != 0};
+    const auto turned{tc::reoriented(tc::DEFAULT, GLASS, swap, mx, my)};
+    const screen::Dimensions frame{
+        swap ? screen::Dimensions{GLASS.height, GLASS.width} : GLASS};
+    bool turn_ok{true};
+    for (int idx = 0; idx < 500; ++idx) {
+      const int32_t rx{raw(rng)}, ry{raw(rng)};
+      const auto upright{tc::map(tc::DEFAULT, rx, ry, GLASS)};
+      const auto got{tc::map(turned, rx, ry, frame)};
+      /* the address reported is the one that lights up under the finger */
+      turn_ok &= glass_of(swap, mx, my, got.x, got.y) ==
+                 std::pair{upright.x, upright.y};
+    }
+    if (PRINT_DEBUG && !turn_ok) {
+      std::cerr << "  swap " << swap << " mirror x " << mx << " mirror y "
+                << my << " lands in the wrong place\n";
+    }
+    status &= turn_ok;
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_record() {
+  bool status{true};
+  const TouchCalibration cal{.xx = -4700,
+                             .xy = 12,
+                             .x0 = 16800000,
+                             .yx = -9,
+                             .yy = -5980,
+                             .y0 = 22999999};
+  const auto rec{tc::make_record(cal)};
+
+  TouchCalibration out{};
+  status &= tc::read_record(rec, out);
+  status &= std::memcmp(&out, &cal, sizeof(cal)) == 0;
+
+  /* erased flash */
+  TouchCalibrationRecord erased;
+  std::memset(&erased, 0xFF, sizeof(erased));
+  status &= !tc::read_record(erased, out);
+
+  /* any single bit gone wrong */
+  for (size_t bit = 0; bit < sizeof(rec) * 8; ++bit) {
+    auto bad{rec};
+    reinterpret_cast<uint8_t *>(&bad)[bit / 8] ^= 1U << (bit % 8);
+    status &= !tc::read_record(bad, out);
+  }
+  status &= std::memcmp(&out, &cal, sizeof(cal)) == 0;
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+  std::mt19937 rng{47};
+
+  status &= tests::test_crc();
+  /* as mounted on the board, then flipped other ways and crooked */
+  status &= tests::test_fit({-0.0713, -0.0911, 0.0, 256.8, 350.9}, rng);
+  status &= tests::test_fit({0.0713, -0.0911, 3.5, -20.0, 350.9}, rng);
+  status &= tests::test_fit({-0.06, 0.075, -2.0, 250.0, -20.0}, rng);
+  status &= tests::test_fit({0.06, 0.08, -6.0, -10.0, -20.0}, rng);
+  status &= tests::test_degenerate();
+  status &= tests::test_default();
+  status &= tests::test_reoriented(rng);
+  status &= tests::test_record();
+
+  if (!status) {
+    std::cerr << "test_touch_calibration failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}
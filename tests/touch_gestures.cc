@@ -0,0 +1,284 @@
+#include <iostream>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "gamepad/touch_pad.hpp"
+#include "touch_gestures.hpp"
+
+namespace tests {
+
+static constexpr bool PRINT_DEBUG{true};
+
+using screen::TouchReport;
+using screen::gestures::Direction;
+using screen::gestures::Gesture;
+using screen::gestures::Kind;
+using screen::gestures::Recognizer;
+
+/* Builds the report stream a finger makes: samples every 5 ms while down,
+ * like the touch interrupt, then a pen up. */
+struct Stroke {
+  uint32_t now_us;
+  std::vector<TouchReport> reports{};
+
+  explicit Stroke(uint32_t start_us) : now_us{start_us} {}
+
+  Stroke &at(int x, int y) {
+    reports.push_back(
+        {.x = x, .y = y, .pen_up = false, .timestamp_us = now_us});
+    now_us += 5000;
+    return *this;
+  }
+  /* n samples walking in a straight line from (x0, y0) to (x1, y1) */
+  Stroke &line(int x0, int y0, int x1, int y1, int n) {
+    for (int idx = 0; idx <= n; ++idx) {
+      at(x0 + (x1 - x0) * idx / n, y0 + (y1 - y0) * idx / n);
+    }
+    return *this;
+  }
+  Stroke &hold(int x, int y, uint32_t duration_us) {
+    for (uint32_t held_us = 0; held_us <= duration_us; held_us += 5000) {
+      at(x, y);
+    }
+    return *this;
+  }
+  Stroke &up() {
+    reports.push_back(
+        {.x = -1, .y = -1, .pen_up = true, .timestamp_us = now_us});
+    now_us += 5000;
+    return *this;
+  }
+};
+
+[[nodiscard]] std::vector<Gesture> run(Recognizer &rec, const Stroke &stroke) {
+  std::vector<Gesture> out;
+  for (const auto &report : stroke.reports) {
+    const auto gesture{rec.feed(report)};
+    if (gesture.kind != Kind::NONE) {
+      out.push_back(gesture);
+    }
+  }
+  return out;
+}
+
+[[nodiscard]] bool check(const char *name, bool ok) {
+  if (PRINT_DEBUG && !ok) {
+    std::cerr << "  " << name << " failed\n";
+  }
+  return ok;
+}
+
+[[nodiscard]] bool test_tap(uint32_t start_us) {
+  Recognizer rec;
+  bool status{true};
+
+  /* a little jitter is still a tap, reported where it went down */
+  const auto tap{run(rec, Stroke{start_us}
+                              .at(100, 150)
+                              .at(103, 148)
+                              .at(98, 153)
+                              .at(101, 150)
+                              .up())};
+  status &= check("tap", tap.size() == 1 && tap[0].kind == Kind::TAP &&
+                             tap[0].x == 100 && tap[0].y == 150);
+
+  /* too slow for a tap, too quick for a long press: nothing */
+  const auto dawdle{
+      run(rec, Stroke{start_us}.hold(50, 50, 450 * 1000).up())};
+  status &= check("dawdle", dawdle.empty());
+
+  /* and taps keep coming, one per stroke */
+  for (int idx = 0; idx < 3; ++idx) {
+    const auto again{run(rec, Stroke{start_us}.at(10, 10).at(11, 10).up())};
+    status &= check("again", again.size() == 1 && again[0].kind == Kind::TAP);
+  }
+  return status;
+}
+
+[[nodiscard]] bool test_long_press(uint32_t start_us) {
+  Recognizer rec;
+  bool status{true};
+
+  /* fires once, while still down, and letting go adds nothing */
+  const auto held{
+      run(rec, Stroke{start_us}.hold(60, 70, 1500 * 1000).up())};
+  status &= check("long press", held.size() == 1 &&
+                                    held[0].kind == Kind::LONG_PRESS &&
+                                    held[0].x == 60 && held[0].y == 70 &&
+                                    held[0].held_us >= 600 * 1000 &&
+                                    held[0].held_us < 610 * 1000);
+
+  /* held, then dragged: a long press, then a drag */
+  const auto moved{run(rec, Stroke{start_us}
+                                .hold(60, 70, 700 * 1000)
+                                .line(60, 70, 160, 70, 10)
+                                .up())};
+  status &= check("press then drag",
+                  moved.size() >= 3 && moved[0].kind == Kind::LONG_PRESS &&
+                      moved[1].kind == Kind::DRAG_START &&
+                      moved.back().kind == Kind::DRAG_END);
+  return status;
+}
+
+[[nodiscard]] bool test_drag(uint32_t start_us) {
+  Recognizer rec;
+  bool status{true};
+
+  /* slow enough not to be a swipe */
+  const auto drag{run(rec, Stroke{start_us}
+                               .line(20, 20, 20, 220, 100)
+                               .up())};
+  status &= check("drag events", drag.size() >= 3 &&
+                                     drag.front().kind == Kind::DRAG_START &&
+                                     drag.back().kind == Kind::DRAG_END);
+
+  /* the DRAG steps add up to the whole move, nothing lost or doubled */
+  int sum_x{drag.front().dx}, sum_y{drag.front().dy};
+  for (size_t idx = 1; idx + 1 < drag.size(); ++idx) {
+    status &= check("drag kind", drag[idx].kind == Kind::DRAG);
+    sum_x += drag[idx].dx;
+    sum_y += drag[idx].dy;
+  }
+  status &= check("drag sum", sum_x == 0 && sum_y == 200);
+  status &= check("drag end", drag.back().x == 20 && drag.back().y == 220 &&
+                                  drag.back().dx == 0 &&
+                                  drag.back().dy == 200);
+  return status;
+}
+
+[[nodiscard]] bool test_swipe(uint32_t start_us) {
+  Recognizer rec;
+  bool status{true};
+
+  struct Case {
+    int x1;
+    int y1;
+    Direction dir;
+  };
+  /* from the middle, a flick each way, slightly off axis */
+  for (const Case c : {Case{120, 60, Direction::UP},
+                       Case{110, 260, Direction::DOWN},
+                       Case{20, 150, Direction::LEFT},
+                       Case{220, 170, Direction::RIGHT}}) {
+    const auto flick{run(rec, Stroke{start_us}
+                                  .line(120, 160, c.x1, c.y1, 8)
+                                  .up())};
+    status &= check("swipe", !flick.empty() &&
+                                 flick.back().kind == Kind::SWIPE &&
+                                 flick.back().direction == c.dir &&
+                                 flick.back().x == 120 &&
+                                 flick.back().y == 160);
+  }
+
+  /* quick but short is a drag */
+  const auto nudge{
+      run(rec, Stroke{start_us}.line(120, 160, 140, 160, 4).up())};
+  status &= check("nudge",
+                  !nudge.empty() && nudge.back().kind == Kind::DRAG_END);
+  return status;
+}
+
+[[nodiscard]] bool test_configured(uint32_t start_us) {
+  bool status{true};
+  /* a looser slop keeps a small move a tap */
+  Recognizer rec{{.slop_px = 30}};
+  const auto tap{run(rec, Stroke{start_us}.line(100, 100, 120, 100, 3).up())};
+  status &= check("slop", tap.size() == 1 && tap[0].kind == Kind::TAP);
+
+  /* a shorter long press */
+  rec.config({.long_press_us = 100 * 1000});
+  const auto held{run(rec, Stroke{start_us}.hold(5, 5, 150 * 1000).up())};
+  status &= check("config", held.size() == 1 &&
+                                held[0].kind == Kind::LONG_PRESS);
+
+  /* reset drops the stroke under way */
+  rec.reset();
+  Stroke broken{start_us};
+  broken.at(10, 10).line(10, 10, 200, 10, 5);
+  (void)run(rec, broken);
+  rec.reset();
+  const auto after{run(rec, Stroke{broken.now_us}.up())};
+  status &= check("reset", after.empty());
+  return status;
+}
+
+[[nodiscard]] bool test_touch_pad() {
+  using gamepad::five::Button;
+  using gamepad::five::TouchPad;
+  bool status{true};
+
+  auto &&press{[](TouchPad &pad, int x, int y) {
+    pad.feed({.x = x, .y = y, .pen_up = false, .timestamp_us = 0});
+    return pad.state();
+  }};
+  auto &&same{[](gamepad::five::State got, uint8_t up, uint8_t down,
+                 uint8_t right, uint8_t left, uint8_t etc) {
+    return got.up == up && got.down == down && got.right == right &&
+           got.left == left && got.etc == etc;
+  }};
+
+  auto pad{TouchPad::dpad({.width = 240, .height = 320})};
+  status &= check("dpad zones", pad.size() == 5);
+  status &= check("dpad up", same(press(pad, 120, 10), 1, 0, 0, 0, 0));
+  status &= check("dpad down", same(press(pad, 5, 315), 0, 1, 0, 0, 0));
+  status &= check("dpad left", same(press(pad, 10, 160), 0, 0, 0, 1, 0));
+  status &= check("dpad right", same(press(pad, 239, 160), 0, 0, 1, 0, 0));
+  status &= check("dpad etc", same(press(pad, 120, 160), 0, 0, 0, 0, 1));
+
+  /* edges: the last row of the up band, the first of the middle */
+  status &= check("dpad edge", same(press(pad, 120, 105), 1, 0, 0, 0, 0) &&
+                                   same(press(pad, 120, 106), 0, 0, 0, 0, 1));
+
+  /* letting go lets go of everything */
+  pad.feed({.x = -1, .y = -1, .pen_up = true, .timestamp_us = 0});
+  status &= check("dpad release", same(pad.state(), 0, 0, 0, 0, 0));
+
+  /* off the edge of every zone is nothing held */
+  status &= check("dpad outside", same(press(pad, 500, 500), 0, 0, 0, 0, 0));
+
+  /* overlapping zones hold two buttons, e.g. a diagonal corner */
+  TouchPad custom;
+  status &= custom.add({.area = {.x = 0, .y = 0, .width = 100, .height = 50},
+                        .button = Button::UP});
+  status &= custom.add({.area = {.x = 50, .y = 0, .width = 50, .height = 100},
+                        .button = Button::RIGHT});
+  status &= check("overlap", same(press(custom, 75, 25), 1, 0, 1, 0, 0) &&
+                                 same(press(custom, 25, 25), 1, 0, 0, 0, 0) &&
+                                 same(press(custom, 75, 75), 0, 0, 1, 0, 0));
+
+  /* and no more than there is room for */
+  while (custom.size() < TouchPad::MAX_ZONES) {
+    status &= custom.add({.area = {}, .button = Button::ETC});
+  }
+  status &= check("full", !custom.add({.area = {}, .button = Button::ETC}));
+  custom.clear();
+  status &= check("clear", custom.size() == 0 &&
+                               same(custom.state(), 0, 0, 0, 0, 0));
+  return status;
+}
+
+} // namespace tests
+
+int main() {
+  bool status{true};
+
+  /* once from zero, and once with the microsecond clock about to wrap */
+  for (const uint32_t start_us : {0U, 0xFFFFFFFFU - 200 * 1000}) {
+    status &= tests::test_tap(start_us);
+    status &= tests::test_long_press(start_us);
+    status &= tests::test_drag(start_us);
+    status &= tests::test_swipe(start_us);
+    status &= tests::test_configured(start_us);
+  }
+  status &= tests::test_touch_pad();
+
+  if (!status) {
+    std::cerr << "test_touch_gestures failed!\n";
+    return 1;
+  }
+
+  std::cerr << "All tests passed!\n";
+}